@@ -0,0 +1,256 @@
+#include <stdlib.h>
+#include <string.h>
+#include "allocator.h"
+
+/* ============= PER-ROW BLOCK SUMMARIES ============= */
+
+int alloc_policy = ALLOC_POLICY_COMPACT;
+
+/* Score the blocks of one free run [a, b]. Under the compact policy each
+ * block loses ORPHAN_PENALTY for every side on which it would leave exactly
+ * one free seat behind, so a block that fills the run or leaves room for
+ * another group wins over a slightly better seat that strands a single. */
+static void score_run(int *best, short *start, const long *prefix, int a, int b) {
+    int len = b - a + 1;
+    int max_k = len < MAX_GROUP_SEATS ? len : MAX_GROUP_SEATS;
+    for (int k = 1; k <= max_k; ++k) {
+        for (int c = a; c + k - 1 <= b; ++c) {
+            int total = (int)(prefix[c + k] - prefix[c]);
+            if (alloc_policy == ALLOC_POLICY_COMPACT) {
+                if (c - a == 1) total -= ORPHAN_PENALTY;
+                if (b - (c + k - 1) == 1) total -= ORPHAN_PENALTY;
+            }
+            if (total > best[k - 1]) { best[k - 1] = total; start[k - 1] = (short)c; }
+        }
+    }
+}
+
+/* Recompute the best block of every size for one row, run by run (runs
+ * are cut by booked seats and aisles), with prefix sums of seat scores so
+ * each window is scored in O(1). Also refreshes the row's fragmentation
+ * counters. */
+static void compute_row(AllocIndex *ix, const VenueLayout *v, const SeatOccupancy *o, int row) {
+    int *best = ix->best_score + (size_t)row * MAX_GROUP_SEATS;
+    short *start = ix->best_start + (size_t)row * MAX_GROUP_SEATS;
+    for (int k = 0; k < MAX_GROUP_SEATS; ++k) best[k] = NO_BLOCK;
+    ix->orphans -= ix->row_orphans[row];
+    ix->runs -= ix->row_runs[row];
+    ix->row_orphans[row] = ix->row_runs[row] = 0;
+    if (o->row_free[row] == 0) return;
+
+    int section = v->row_section[row];
+    const Section *sec = &v->sections[section];
+    const int *score = v->seat_score + sec->seat_offset + (size_t)(row - sec->row_offset) * sec->cols;
+    const uint64_t *w = o->bits + sec->word_offset + (size_t)(row - sec->row_offset) * sec->words_per_row;
+
+    long prefix[MAX_SECTION_COLS + 1];
+    prefix[0] = 0;
+    for (int c = 0; c < sec->cols; ++c) prefix[c + 1] = prefix[c] + score[c];
+
+    int run_start = -1;
+    for (int c = 0; c < sec->cols; ++c) {
+        if ((w[c >> 6] >> (c & 63)) & 1u) continue;
+        if (run_start < 0) run_start = c;
+        if (c + 1 < sec->cols && !venue_aisle_after(v, section, c) && !((w[(c + 1) >> 6] >> ((c + 1) & 63)) & 1u)) continue;
+        score_run(best, start, prefix, run_start, c);
+        ix->row_runs[row]++;
+        if (c == run_start) ix->row_orphans[row]++;
+        run_start = -1;
+    }
+    ix->orphans += ix->row_orphans[row];
+    ix->runs += ix->row_runs[row];
+}
+
+/* ============= SEGMENT TREES ============= */
+
+static int *tree_for(AllocIndex *ix, int k) {
+    return ix->tree + (size_t)(k - 1) * 2 * ix->leaves;
+}
+
+/* Better of two rows for group size k; ties go to the earlier row */
+static int better_row(const AllocIndex *ix, int k, int a, int b) {
+    if (a < 0) return b;
+    if (b < 0) return a;
+    int sa = ix->best_score[(size_t)a * MAX_GROUP_SEATS + k - 1];
+    int sb = ix->best_score[(size_t)b * MAX_GROUP_SEATS + k - 1];
+    if (sb > sa || (sb == sa && b < a)) return b;
+    return a;
+}
+
+static int leaf_value(const AllocIndex *ix, int k, int row) {
+    return ix->best_score[(size_t)row * MAX_GROUP_SEATS + k - 1] == NO_BLOCK ? -1 : row;
+}
+
+static void tree_update(AllocIndex *ix, int k, int row) {
+    int *t = tree_for(ix, k);
+    int node = ix->leaves + row;
+    t[node] = leaf_value(ix, k, row);
+    for (node >>= 1; node >= 1; node >>= 1) t[node] = better_row(ix, k, t[2 * node], t[2 * node + 1]);
+}
+
+static void tree_build(AllocIndex *ix, int k) {
+    int *t = tree_for(ix, k);
+    for (int i = 0; i < ix->leaves; ++i) t[ix->leaves + i] = i < ix->rows ? leaf_value(ix, k, i) : -1;
+    for (int node = ix->leaves - 1; node >= 1; --node) t[node] = better_row(ix, k, t[2 * node], t[2 * node + 1]);
+}
+
+/* Bring dirty rows up to date. When most rows changed (e.g. right after
+ * loading) the trees are rebuilt bottom-up instead of patched per row. */
+static void refresh(AllocIndex *ix, const VenueLayout *v, const SeatOccupancy *o) {
+    if (ix->dirty_count == 0) return;
+    int rebuild = ix->dirty_count > ix->rows / 4;
+    for (int i = 0; i < ix->dirty_count; ++i) {
+        int row = ix->dirty_rows[i];
+        ix->dirty[row] = 0;
+        compute_row(ix, v, o, row);
+        if (!rebuild) for (int k = 1; k <= MAX_GROUP_SEATS; ++k) tree_update(ix, k, row);
+    }
+    if (rebuild) for (int k = 1; k <= MAX_GROUP_SEATS; ++k) tree_build(ix, k);
+    ix->dirty_count = 0;
+}
+
+/* ============= PUBLIC API ============= */
+
+AllocIndex *alloc_index_create(const VenueLayout *v) {
+    AllocIndex *ix = (AllocIndex *)calloc(1, sizeof(AllocIndex));
+    if (!ix) return NULL;
+    ix->rows = v->total_rows;
+    ix->leaves = 1;
+    while (ix->leaves < ix->rows) ix->leaves <<= 1;
+    size_t cells = (size_t)ix->rows * MAX_GROUP_SEATS;
+    ix->best_score = (int *)malloc(sizeof(int) * cells);
+    ix->best_start = (short *)malloc(sizeof(short) * cells);
+    ix->tree = (int *)malloc(sizeof(int) * (size_t)MAX_GROUP_SEATS * 2 * ix->leaves);
+    ix->dirty = (unsigned char *)malloc((size_t)ix->rows);
+    ix->dirty_rows = (int *)malloc(sizeof(int) * (size_t)ix->rows);
+    ix->row_orphans = (short *)calloc((size_t)ix->rows, sizeof(short));
+    ix->row_runs = (short *)calloc((size_t)ix->rows, sizeof(short));
+    if (!ix->best_score || !ix->best_start || !ix->tree || !ix->dirty || !ix->dirty_rows ||
+        !ix->row_orphans || !ix->row_runs) {
+        alloc_index_free(ix);
+        return NULL;
+    }
+    /* Every row starts dirty; the first query builds the whole index */
+    memset(ix->dirty, 1, (size_t)ix->rows);
+    for (int r = 0; r < ix->rows; ++r) ix->dirty_rows[r] = r;
+    ix->dirty_count = ix->rows;
+    return ix;
+}
+
+void alloc_index_free(AllocIndex *ix) {
+    if (!ix) return;
+    free(ix->best_score);
+    free(ix->best_start);
+    free(ix->tree);
+    free(ix->dirty);
+    free(ix->dirty_rows);
+    free(ix->row_orphans);
+    free(ix->row_runs);
+    free(ix);
+}
+
+/* Note that a seat changed; its row is recomputed on the next query */
+void alloc_index_touch(AllocIndex *ix, const VenueLayout *v, SeatRef s) {
+    int row = v->sections[s.section].row_offset + s.row;
+    if (ix->dirty[row]) return;
+    ix->dirty[row] = 1;
+    ix->dirty_rows[ix->dirty_count++] = row;
+}
+
+int alloc_best_block(AllocIndex *ix, const VenueLayout *v, const SeatOccupancy *o, int k, SeatRef *first) {
+    if (k < 1 || k > MAX_GROUP_SEATS) return 0;
+    refresh(ix, v, o);
+    int row = tree_for(ix, k)[1];
+    if (row < 0) return 0;
+    int section = v->row_section[row];
+    first->section = section;
+    first->row = row - v->sections[section].row_offset;
+    first->col = ix->best_start[(size_t)row * MAX_GROUP_SEATS + k - 1];
+    return 1;
+}
+
+/* Seats of a k-seat area h rows deep starting at (row, col): full rows of
+ * w seats, then the remainder centred in the back row */
+static int area_seats(int section, int row, int col, int h, int w, int k, SeatRef out[]) {
+    int n = 0;
+    for (int i = 0; i < h; ++i) {
+        int take = (i < h - 1) ? w : k - (h - 1) * w;
+        int first = col + (w - take) / 2;
+        for (int j = 0; j < take; ++j) {
+            out[n].section = section;
+            out[n].row = row + i;
+            out[n].col = first + j;
+            n++;
+        }
+    }
+    return n;
+}
+
+static long area_score(const VenueLayout *v, const SeatRef seats[], int k) {
+    long total = 0;
+    for (int i = 0; i < k; ++i) total += venue_seat_score(v, seats[i]);
+    return total;
+}
+
+/* Sliding window over each section's rows: for h adjacent rows the
+ * occupancy words are ORed together, so a free run of w = ceil(k/h) bits
+ * in the result (not crossing an aisle) is a column range free in every
+ * row. Each start column is scored by the seats it would take. Rows with
+ * fewer than w free seats end the window early. Work is bounded by
+ * rows * words * depth plus the free columns scanned. */
+int alloc_best_area(const VenueLayout *v, const SeatOccupancy *o, int k, SeatRef out[]) {
+    if (k < 3 || k > MAX_GROUP_SEATS || v->total_seats - o->booked < k) return 0;
+    long best = 0;
+    int found = 0;
+    SeatRef cand[MAX_GROUP_SEATS];
+    uint64_t mask[MAX_SECTION_COLS / 64];
+
+    for (int sidx = 0; sidx < v->section_count; ++sidx) {
+        const Section *sec = &v->sections[sidx];
+        for (int h = 2; h <= (k + 1) / 2 && h <= sec->rows; ++h) {
+            int w = (k + h - 1) / h;
+            if (w > sec->cols || (h - 1) * w >= k) continue;
+            for (int r = 0; r + h <= sec->rows; ++r) {
+                int usable = 1;
+                for (int i = 0; i < h && usable; ++i) usable = o->row_free[sec->row_offset + r + i] >= w;
+                if (!usable) continue;
+                const uint64_t *rows = o->bits + sec->word_offset + (size_t)r * sec->words_per_row;
+                for (int wi = 0; wi < sec->words_per_row; ++wi) {
+                    mask[wi] = 0;
+                    for (int i = 0; i < h; ++i) mask[wi] |= rows[(size_t)i * sec->words_per_row + wi];
+                }
+                int run = 0;
+                for (int c = 0; c < sec->cols; ++c) {
+                    if ((c & 63) == 0 && mask[c >> 6] == ~(uint64_t)0) { run = 0; c += 63; continue; }
+                    if ((mask[c >> 6] >> (c & 63)) & 1u) { run = 0; continue; }
+                    if (++run >= w) {
+                        area_seats(sidx, r, c - w + 1, h, w, k, cand);
+                        long score = area_score(v, cand, k);
+                        if (!found || score > best) {
+                            best = score;
+                            found = 1;
+                            for (int i = 0; i < k; ++i) out[i] = cand[i];
+                        }
+                    }
+                    if (venue_aisle_after(v, sidx, c)) run = 0;
+                }
+            }
+        }
+    }
+    return found;
+}
+
+int alloc_best_seats(const VenueLayout *v, const SeatOccupancy *o, int k, SeatRef out[]) {
+    int found = 0;
+    for (int i = 0; i < v->total_seats && found < k; ++i) {
+        SeatRef s = venue_seat_from_number(v, v->rank_order[i]);
+        if (!occupancy_test(o, v, s)) out[found++] = s;
+    }
+    return found == k;
+}
+
+void alloc_fragmentation(AllocIndex *ix, const VenueLayout *v, const SeatOccupancy *o, int *orphans, int *runs) {
+    refresh(ix, v, o);
+    *orphans = ix->orphans;
+    *runs = ix->runs;
+}
@@ -0,0 +1,55 @@
+#ifndef ALLOCATOR_H
+#define ALLOCATOR_H
+
+#include <limits.h>
+#include "venue.h"
+
+#define MAX_GROUP_SEATS 10
+#define NO_BLOCK INT_MIN
+#define ORPHAN_PENALTY 1500   /* score cost of leaving one unsellable single seat */
+
+/* How candidate blocks are ranked */
+enum {
+    ALLOC_POLICY_BEST = 0,    /* highest seat-quality score only */
+    ALLOC_POLICY_COMPACT = 1  /* score minus a penalty per orphan seat left beside the block */
+};
+extern int alloc_policy;
+
+/* Best-available index for one event. For every row and group size k it
+ * keeps the best-scoring block of k adjacent free seats (not crossing an
+ * aisle); for every k a max segment tree over rows finds the best row in
+ * O(1) and is updated in O(log rows). Rows touched by a booking or
+ * cancellation are marked dirty and recomputed on the next query. */
+typedef struct AllocIndex {
+    int rows;             /* rows in the layout */
+    int leaves;           /* segment tree leaves, a power of two */
+    int *best_score;      /* [row * MAX_GROUP_SEATS + k-1], NO_BLOCK if none */
+    short *best_start;    /* first column of that block */
+    int *tree;            /* [(k-1) * 2 * leaves + node] row with the best block */
+    unsigned char *dirty; /* per row */
+    int *dirty_rows;
+    int dirty_count;
+    short *row_orphans;   /* free seats with no free neighbour in their run */
+    short *row_runs;      /* free runs (split by booked seats and aisles) */
+    int orphans;          /* totals over all rows */
+    int runs;
+} AllocIndex;
+
+AllocIndex *alloc_index_create(const VenueLayout *v);
+void alloc_index_free(AllocIndex *ix);
+void alloc_index_touch(AllocIndex *ix, const VenueLayout *v, SeatRef s);
+
+/* Best block of k adjacent seats; returns 1 and its first seat, or 0 */
+int alloc_best_block(AllocIndex *ix, const VenueLayout *v, const SeatOccupancy *o, int k, SeatRef *first);
+
+/* Best compact block spanning 2 or more adjacent rows of one section,
+ * e.g. 3+3 or 4+4+2; fills out[] front row first, returns 1 if found */
+int alloc_best_area(const VenueLayout *v, const SeatOccupancy *o, int k, SeatRef out[]);
+
+/* The k best free seats anywhere, by precomputed seat rank */
+int alloc_best_seats(const VenueLayout *v, const SeatOccupancy *o, int k, SeatRef out[]);
+
+/* Fragmentation: isolated free seats and number of free runs */
+void alloc_fragmentation(AllocIndex *ix, const VenueLayout *v, const SeatOccupancy *o, int *orphans, int *runs);
+
+#endif /* ALLOCATOR_H */
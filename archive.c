@@ -0,0 +1,418 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "archive.h"
+#include "events.h"
+#include "bookings.h"
+#include "columns.h"
+#include "eventindex.h"
+#include "persist.h"
+#include "utils.h"
+
+#define LZ_MIN_MATCH 4
+#define LZ_HASH_BITS 14
+#define LZ_MAX_OFFSET 65535
+#define ARCHIVE_MAGIC "ARC|"
+#define ARCHIVE_HEADER_MAX (MAX_LAYOUT_SPEC + 512)
+#define ARCHIVE_SUMMARY_RECENT 5
+
+ArchivedEvent *archived_events = NULL;
+int archived_count = 0;
+static int archived_capacity = 0;
+static char archive_path[256] = "archive.dat";
+static long archive_end = 0;   /* end of the last complete segment */
+
+/* ============= LZ COMPRESSION ============= */
+
+/* A sequence is a token (literal count << 4 | match length - 4, 15 meaning
+ * "more follows in 255-capped bytes"), the literals, then a 2-byte offset
+ * back into the output. The last sequence has literals only. Booking
+ * records repeat usernames, e-mail domains and ID prefixes, so even this
+ * greedy single-probe matcher about halves them. */
+
+size_t lz_bound(size_t n) {
+    return n + n / 255 + 16;
+}
+
+static unsigned int read32(const unsigned char *p) {
+    unsigned int v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+static unsigned char *put_length(unsigned char *op, size_t len) {
+    while (len >= 255) { *op++ = 255; len -= 255; }
+    *op++ = (unsigned char)len;
+    return op;
+}
+
+static unsigned char *put_literals(unsigned char *op, const unsigned char *lit, size_t n, size_t match) {
+    *op++ = (unsigned char)((n >= 15 ? 15 : n) << 4 | (match >= 15 ? 15 : match));
+    if (n >= 15) op = put_length(op, n - 15);
+    memcpy(op, lit, n);
+    return op + n;
+}
+
+size_t lz_compress(const unsigned char *src, size_t n, unsigned char *dst) {
+    size_t *table = (size_t *)calloc((size_t)1 << LZ_HASH_BITS, sizeof(size_t));
+    if (!table) { fprintf(stderr, "Memory allocation failed\n"); exit(1); }
+    unsigned char *op = dst;
+    size_t ip = 0, anchor = 0;
+    while (ip + LZ_MIN_MATCH <= n) {
+        unsigned int seq = read32(src + ip);
+        unsigned int h = (seq * 2654435761u) >> (32 - LZ_HASH_BITS);
+        size_t cand = table[h];   /* position + 1, 0 = empty */
+        table[h] = ip + 1;
+        if (!cand || ip - (cand - 1) > LZ_MAX_OFFSET || read32(src + cand - 1) != seq) { ip++; continue; }
+        size_t ref = cand - 1, len = LZ_MIN_MATCH;
+        while (ip + len < n && src[ref + len] == src[ip + len]) len++;
+        op = put_literals(op, src + anchor, ip - anchor, len - LZ_MIN_MATCH);
+        size_t off = ip - ref;
+        *op++ = (unsigned char)(off & 255);
+        *op++ = (unsigned char)(off >> 8);
+        if (len - LZ_MIN_MATCH >= 15) op = put_length(op, len - LZ_MIN_MATCH - 15);
+        ip += len;
+        anchor = ip;
+    }
+    op = put_literals(op, src + anchor, n - anchor, 0);
+    free(table);
+    return (size_t)(op - dst);
+}
+
+/* Returns 1 only if src decodes to exactly dst_len bytes */
+int lz_decompress(const unsigned char *src, size_t n, unsigned char *dst, size_t dst_len) {
+    size_t ip = 0, op = 0;
+    while (ip < n) {
+        unsigned char token = src[ip++];
+        size_t lit = token >> 4, b;
+        if (lit == 15) do { if (ip >= n) return 0; b = src[ip++]; lit += b; } while (b == 255);
+        if (lit > n - ip || lit > dst_len - op) return 0;
+        memcpy(dst + op, src + ip, lit);
+        ip += lit;
+        op += lit;
+        if (ip == n) break;
+        if (n - ip < 2) return 0;
+        size_t off = src[ip] | (size_t)src[ip + 1] << 8;
+        ip += 2;
+        size_t len = token & 15;
+        if (len == 15) do { if (ip >= n) return 0; b = src[ip++]; len += b; } while (b == 255);
+        len += LZ_MIN_MATCH;
+        if (off == 0 || off > op || len > dst_len - op) return 0;
+        for (size_t i = 0; i < len; ++i) dst[op + i] = dst[op - off + i];   /* may overlap */
+        op += len;
+    }
+    return op == dst_len;
+}
+
+static unsigned int checksum(const unsigned char *p, size_t n) {
+    unsigned int h = 2166136261u;
+    for (size_t i = 0; i < n; ++i) { h ^= p[i]; h *= 16777619u; }
+    return h;
+}
+
+/* ============= INDEX ============= */
+
+static ArchivedEvent *append_entry(void) {
+    if (archived_count == archived_capacity) {
+        int cap = archived_capacity ? archived_capacity * 2 : 16;
+        ArchivedEvent *tmp = (ArchivedEvent *)realloc(archived_events, sizeof(ArchivedEvent) * (size_t)cap);
+        if (!tmp) { fprintf(stderr, "Memory allocation failed\n"); exit(1); }
+        archived_events = tmp;
+        archived_capacity = cap;
+    }
+    ArchivedEvent *a = &archived_events[archived_count++];
+    memset(a, 0, sizeof(*a));
+    return a;
+}
+
+/* Header: ARC|raw_len|packed_len|checksum|bookings|total_seats|revenue|<event record> */
+static int parse_header(char *line, ArchivedEvent *a) {
+    if (strncmp(line, ARCHIVE_MAGIC, 4) != 0) return 0;
+    char *p = line + 4, *end;
+    a->raw_len = strtoul(p, &end, 10); if (*end != '|') return 0; p = end + 1;
+    a->packed_len = strtoul(p, &end, 10); if (*end != '|') return 0; p = end + 1;
+    a->checksum = (unsigned int)strtoul(p, &end, 10); if (*end != '|') return 0; p = end + 1;
+    a->bookings = (int)strtol(p, &end, 10); if (*end != '|') return 0; p = end + 1;
+    a->total_seats = (int)strtol(p, &end, 10); if (*end != '|') return 0; p = end + 1;
+    a->revenue = strtod(p, &end); if (*end != '|') return 0; p = end + 1;
+
+    /* name|base|rows|cols|code|percent|date|time[|layout] */
+    char *fields[8];
+    char *rec = p;
+    for (int i = 0; i < 8; ++i) {
+        fields[i] = rec;
+        char *bar = strchr(rec, '|');
+        if (!bar && i < 7) return 0;
+        rec = bar ? bar + 1 : rec + strlen(rec);
+    }
+    a->record = strdup(p);
+    if (!a->record) { fprintf(stderr, "Memory allocation failed\n"); exit(1); }
+    snprintf(a->name, sizeof(a->name), "%.*s", (int)(fields[1] - fields[0] - 1), fields[0]);
+    a->base_price = atof(fields[1]);
+    snprintf(a->event_date, sizeof(a->event_date), "%.*s", (int)strcspn(fields[6], "|"), fields[6]);
+    snprintf(a->event_time, sizeof(a->event_time), "%.*s", (int)strcspn(fields[7], "|"), fields[7]);
+    return 1;
+}
+
+int archive_load_index(const char *path) {
+    snprintf(archive_path, sizeof(archive_path), "%s", path);
+    archive_end = 0;
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return 0;   /* nothing archived yet */
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    char *line = (char *)malloc(ARCHIVE_HEADER_MAX);
+    if (!line) { fprintf(stderr, "Memory allocation failed\n"); exit(1); }
+    while (archive_end < size && fgets(line, ARCHIVE_HEADER_MAX, fp)) {
+        size_t len = strlen(line);
+        if (len == 0 || line[len - 1] != '\n') break;
+        line[len - 1] = '\0';
+        ArchivedEvent *a = append_entry();
+        a->offset = ftell(fp);
+        if (!parse_header(line, a) || a->offset + (long)a->packed_len + 1 > size) {
+            free(a->record);
+            archived_count--;
+            break;
+        }
+        fseek(fp, a->offset + (long)a->packed_len + 1, SEEK_SET);
+        archive_end = a->offset + (long)a->packed_len + 1;
+    }
+    free(line);
+    fclose(fp);
+    if (archive_end < size) {
+        fprintf(stderr, "Warning: dropping an incomplete segment at the end of %s\n", path);
+        if (truncate(path, archive_end) != 0) fprintf(stderr, "Warning: could not truncate %s\n", path);
+    }
+    return archived_count;
+}
+
+void archive_free(void) {
+    for (int i = 0; i < archived_count; ++i) free(archived_events[i].record);
+    free(archived_events);
+    archived_events = NULL;
+    archived_count = archived_capacity = 0;
+}
+
+/* ============= ARCHIVING ============= */
+
+static int already_archived(const EventInfo *e) {
+    for (int i = archived_count - 1; i >= 0; --i) {
+        const ArchivedEvent *a = &archived_events[i];
+        if (strcmp(a->event_date, e->event_date) == 0 && strcmp(a->event_time, e->event_time) == 0 &&
+            strcmp(a->name, e->name) == 0) return 1;
+    }
+    return 0;
+}
+
+/* Append one event's segment; the caller fsyncs once for the batch */
+static int write_segment(FILE *fp, int event_idx) {
+    const Event *e = &events[event_idx];
+    TextBuf raw, rec;
+    tb_init(&raw, 4096);
+    for (const Booking *b = e->bookings_head; b; b = b->next) format_booking_record(&raw, b);
+    tb_init(&rec, 256);
+    format_event_record(&rec, event_idx);
+    rec.data[--rec.len] = '\0';   /* drop the newline */
+
+    unsigned char *packed = (unsigned char *)malloc(lz_bound(raw.len));
+    if (!packed) { fprintf(stderr, "Memory allocation failed\n"); exit(1); }
+    size_t packed_len = lz_compress((const unsigned char *)raw.data, raw.len, packed);
+
+    ArchivedEvent *a = append_entry();
+    char header[ARCHIVE_HEADER_MAX];
+    int hl = snprintf(header, sizeof(header), ARCHIVE_MAGIC "%zu|%zu|%u|%d|%d|%.2f|%s\n",
+                      raw.len, packed_len, checksum(packed, packed_len), get_seats_booked(event_idx),
+                      get_total_seats(event_idx), e->revenue, rec.data);
+    int ok = hl > 0 && hl < (int)sizeof(header) &&
+             fwrite(header, 1, (size_t)hl, fp) == (size_t)hl &&
+             fwrite(packed, 1, packed_len, fp) == packed_len && fputc('\n', fp) != EOF;
+    if (ok) {
+        header[hl - 1] = '\0';
+        ok = parse_header(header, a);
+    }
+    if (ok) {
+        a->offset = archive_end + hl;
+        archive_end = a->offset + (long)packed_len + 1;
+    } else {
+        archived_count--;
+    }
+    free(packed);
+    tb_free(&raw);
+    tb_free(&rec);
+    return ok;
+}
+
+int archive_past_events(void) {
+    char today[20];
+    time_t now = time(NULL);
+    struct tm tm_info;
+    localtime_r(&now, &tm_info);
+    strftime(today, sizeof(today), "%Y-%m-%d", &tm_info);
+
+    int due = 0;
+    for (int i = 0; i < event_count; ++i) if (strcmp(event_info[i].event_date, today) < 0) due++;
+    if (due == 0) return 0;
+
+    FILE *fp = fopen(archive_path, "ab");
+    if (!fp) { printf("Warning: cannot open %s; nothing archived.\n", archive_path); return 0; }
+    fseek(fp, 0, SEEK_END);
+    long batch_start = archive_end = ftell(fp);
+    unsigned char *drop = (unsigned char *)calloc((size_t)event_count, 1);
+    if (!drop) { fprintf(stderr, "Memory allocation failed\n"); exit(1); }
+    int first_new = archived_count, ok = 1;
+    for (int i = 0; i < event_count && ok; ++i) {
+        if (strcmp(event_info[i].event_date, today) >= 0) continue;
+        event_materialize(i);
+        /* Archived before a crash that came before events.txt was rewritten */
+        if (!already_archived(&event_info[i])) ok = write_segment(fp, i);
+        drop[i] = 1;
+    }
+    if (fflush(fp) != 0 || fsync(fileno(fp)) != 0) ok = 0;
+    if (fclose(fp) != 0) ok = 0;
+    if (!ok) {
+        /* Keep every event hot and take the batch back out of the file */
+        for (int i = first_new; i < archived_count; ++i) free(archived_events[i].record);
+        archived_count = first_new;
+        if (truncate(archive_path, batch_start) == 0) archive_end = batch_start;
+        printf("Warning: writing %s failed; nothing archived.\n", archive_path);
+        free(drop);
+        return 0;
+    }
+
+    /* The archive is durable: drop the events and persist without them */
+    int removed = remove_events(drop);
+    free(drop);
+    columns_rebuild();
+    event_index_rebuild();
+    save_events_to_file("events.txt");
+    checkpoint_bookings("bookings.txt");
+    return removed;
+}
+
+/* ============= READING ARCHIVED BOOKINGS ============= */
+
+char *archive_load_bookings(int idx, size_t *len) {
+    if (idx < 0 || idx >= archived_count) return NULL;
+    const ArchivedEvent *a = &archived_events[idx];
+    FILE *fp = fopen(archive_path, "rb");
+    if (!fp) return NULL;
+    unsigned char *packed = (unsigned char *)malloc(a->packed_len + 1);
+    char *raw = (char *)malloc(a->raw_len + 1);
+    if (!packed || !raw) { fprintf(stderr, "Memory allocation failed\n"); exit(1); }
+    int ok = fseek(fp, a->offset, SEEK_SET) == 0 && fread(packed, 1, a->packed_len, fp) == a->packed_len &&
+             checksum(packed, a->packed_len) == a->checksum &&
+             lz_decompress(packed, a->packed_len, (unsigned char *)raw, a->raw_len);
+    fclose(fp);
+    free(packed);
+    if (!ok) { free(raw); return NULL; }
+    raw[a->raw_len] = '\0';
+    if (len) *len = a->raw_len;
+    return raw;
+}
+
+/* Seating layout named by an archived event record, for seat labels */
+static VenueLayout *record_layout(const char *record) {
+    char buf[ARCHIVE_HEADER_MAX];
+    snprintf(buf, sizeof(buf), "%s", record);
+    char *fields[9] = { 0 };
+    char *p = buf;
+    for (int i = 0; i < 9 && p; ++i) {
+        fields[i] = p;
+        char *bar = strchr(p, '|');
+        if (bar) { *bar = '\0'; p = bar + 1; } else p = NULL;
+    }
+    if (fields[8] && fields[8][0] == '@') return venue_template_get(fields[8] + 1);
+    if (fields[8] && fields[8][0]) return venue_layout_intern(fields[8]);
+    if (!fields[3]) return NULL;
+    return venue_layout_intern_grid(atoi(fields[2]), atoi(fields[3]));
+}
+
+int booking_field_matches(int field, const char *value, const char *term) {
+    size_t vl = strlen(value), tl = strlen(term);
+    if (field == 4) return tl <= vl && strncmp(value, term, tl) == 0;
+    if (field == 5) return tl <= vl && strcmp(value + vl - tl, term) == 0;
+    return strcmp(value, term) == 0;
+}
+
+int archive_search_bookings(int field, const char *term, int limit) {
+    int found = 0;
+    for (int i = 0; i < archived_count; ++i) {
+        char *raw = archive_load_bookings(i, NULL);
+        if (!raw) { printf("  (archived event %s could not be read)\n", archived_events[i].name); continue; }
+        VenueLayout *layout = NULL;
+        char *save_line = NULL;
+        for (char *line = strtok_r(raw, "\n", &save_line); line; line = strtok_r(NULL, "\n", &save_line)) {
+            /* event_id|username|display_name|phone|email|row|col|price|booking_id|timestamp|num_seats|section */
+            char *f[12] = { 0 };
+            char *save = NULL;
+            int nf = 0;
+            for (char *tok = strtok_r(line, "|", &save); tok && nf < 12; tok = strtok_r(NULL, "|", &save)) f[nf++] = tok;
+            if (nf < 11) continue;
+            const char *value = field == 1 ? f[8] : field == 2 ? f[1] : f[3];
+            if (!booking_field_matches(field, value, term)) continue;
+            if (found++ >= limit) continue;
+
+            if (!layout) layout = record_layout(archived_events[i].record);
+            char seat[MAX_SEAT_LABEL], time_str[26];
+            SeatRef sr = { f[11] ? atoi(f[11]) : 0, atoi(f[5]), atoi(f[6]) };
+            if (layout && venue_seat_valid(layout, sr)) format_seat_label(layout, sr, seat, sizeof(seat));
+            else snprintf(seat, sizeof(seat), "?");
+            time_t ts = (time_t)atol(f[9]);
+            struct tm tm_info;
+            localtime_r(&ts, &tm_info);
+            strftime(time_str, sizeof(time_str), "%Y-%m-%d %H:%M", &tm_info);
+
+            printf("\n Booking ID: %s\n", f[8]);
+            printf("  Customer: %s\n", f[1]);
+            printf("  Event: %s - %s @ %s (archived)\n", archived_events[i].name,
+                   archived_events[i].event_date, archived_events[i].event_time);
+            printf("  Seat: [%s]\n", seat);
+            printf("  Price Paid: Rs.%.2f\n", atof(f[7]));
+            printf("  Booked On: %s\n", time_str);
+            printf("  Contact: %s | %s\n", f[3], f[4]);
+            printf(" -------------------------------------------------------\n");
+        }
+        if (layout) venue_layout_release(layout);
+        free(raw);
+    }
+    return found;
+}
+
+/* ============= REPORTS ============= */
+
+void show_archive_summary(void) {
+    if (archived_count == 0) return;
+    long seats = 0;
+    double revenue = 0.0;
+    size_t raw = 0, packed = 0;
+    for (int i = 0; i < archived_count; ++i) {
+        seats += archived_events[i].bookings;
+        revenue += archived_events[i].revenue;
+        raw += archived_events[i].raw_len;
+        packed += archived_events[i].packed_len;
+    }
+    printf("Archived Events: %d (%ld seats sold, Rs.%.2f revenue; bookings %zu KB compressed to %zu KB)\n",
+           archived_count, seats, revenue, (raw + 1023) / 1024, (packed + 1023) / 1024);
+    int first = archived_count > ARCHIVE_SUMMARY_RECENT ? archived_count - ARCHIVE_SUMMARY_RECENT : 0;
+    for (int i = archived_count - 1; i >= first; --i) {
+        const ArchivedEvent *a = &archived_events[i];
+        printf("  %s - %s @ %s: %d / %d seats, Rs.%.2f\n", a->name, a->event_date, a->event_time,
+               a->bookings, a->total_seats, a->revenue);
+    }
+}
+
+void archive_events_interactive(void) {
+    double start = now_ms();
+    int moved = archive_past_events();
+    if (moved == 0) {
+        printf("No finished events to archive.\n");
+        return;
+    }
+    printf("Archived %d finished event%s to %s in %.0f ms (%d event%s archived in total).\n",
+           moved, moved == 1 ? "" : "s", archive_path, now_ms() - start,
+           archived_count, archived_count == 1 ? "" : "s");
+}
@@ -0,0 +1,61 @@
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+
+#include <stddef.h>
+
+/* Cold storage for finished events. Each archived event is one segment
+ * appended to the archive file: a text header line with the event record
+ * and its summary figures, then the event's bookings.txt records
+ * LZ-compressed. Only the headers are read at startup; bookings are
+ * decompressed when a search needs them. */
+
+typedef struct ArchivedEvent {
+    char name[100];
+    char event_date[20];
+    char event_time[10];
+    double base_price;
+    double revenue;
+    int bookings;          /* booked seats when archived */
+    int total_seats;
+    long offset;           /* start of the compressed bookings */
+    size_t raw_len;
+    size_t packed_len;
+    unsigned int checksum; /* FNV-1a of the compressed bytes */
+    char *record;          /* events.txt record, for the seating layout */
+} ArchivedEvent;
+
+extern ArchivedEvent *archived_events;
+extern int archived_count;
+
+/* Read the segment headers of path; a torn segment at the end (crash while
+ * archiving) is cut off. Returns the number of archived events. */
+int archive_load_index(const char *path);
+void archive_free(void);
+
+/* Move every event whose date is before today into the archive, then
+ * persist events and bookings without them. Returns events archived. */
+int archive_past_events(void);
+
+/* The bookings.txt records of one archived event (malloc'd, NUL-terminated)
+ * or NULL if the segment can't be read or fails its checksum */
+char *archive_load_bookings(int idx, size_t *len);
+
+/* Booking search over archived events; field is the search menu choice
+ * (1 ID, 2 username, 3 phone, 4 phone prefix, 5 phone suffix). Prints up
+ * to limit matches and returns the number found. */
+int archive_search_bookings(int field, const char *term, int limit);
+
+/* Whether a booking field value matches term under that search choice */
+int booking_field_matches(int field, const char *value, const char *term);
+
+/* Totals and the most recently archived events, for the analytics report */
+void show_archive_summary(void);
+
+void archive_events_interactive(void);
+
+/* Byte-oriented LZ77 (LZ4-style sequences). dst needs lz_bound(n) bytes. */
+size_t lz_bound(size_t n);
+size_t lz_compress(const unsigned char *src, size_t n, unsigned char *dst);
+int lz_decompress(const unsigned char *src, size_t n, unsigned char *dst, size_t dst_len);
+
+#endif /* ARCHIVE_H */
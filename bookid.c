@@ -0,0 +1,124 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bookid.h"
+#include "events.h"
+#include "persist.h"
+
+#define SEQ_BITS 36
+#define EVENT_BITS 24
+#define ID_DIGITS 13
+
+int booking_shard = 0;
+
+static char counters_path[256] = "ids.dat";
+static unsigned int next_event_no = 1;
+static uint64_t next_seq = 1;
+static uint64_t reserved_seq = 0;   /* sequences below this are on disk as used */
+
+/* Crockford base32: no I, L, O or U, so IDs read out loud unambiguously */
+static const char digits[] = "0123456789ABCDEFGHJKMNPQRSTVWXYZ";
+
+static int digit_value(char ch) {
+    const char *p = ch ? strchr(digits, ch) : NULL;
+    return p ? (int)(p - digits) : -1;
+}
+
+/* ============= COUNTERS FILE ============= */
+
+/* IDS|<next event number>|<sequence reserved up to> */
+static void save_counters(void) {
+    char buf[64];
+    int n = snprintf(buf, sizeof(buf), "IDS|%u|%llu\n", next_event_no, (unsigned long long)reserved_seq);
+    if (!write_file_atomic(counters_path, buf, (size_t)n)) {
+        /* Issuing IDs the file doesn't cover could repeat them after a restart */
+        fprintf(stderr, "Fatal: could not save booking ID counters to %s\n", counters_path);
+        exit(1);
+    }
+}
+
+int booking_ids_load(const char *path) {
+    snprintf(counters_path, sizeof(counters_path), "%s", path);
+    FILE *fp = fopen(path, "r");
+    if (fp) {
+        unsigned int ev = 0;
+        unsigned long long seq = 0;
+        if (fscanf(fp, "IDS|%u|%llu", &ev, &seq) == 2) {
+            next_event_no = ev;
+            reserved_seq = seq;
+        }
+        fclose(fp);
+    }
+    /* Anything up to the mark may have been issued before the restart */
+    next_seq = reserved_seq ? reserved_seq : 1;
+
+    /* Trust the events themselves over a missing or stale counters file */
+    for (int i = 0; i < event_count; ++i)
+        if (event_info[i].event_no >= next_event_no) next_event_no = event_info[i].event_no + 1;
+    int numbered = 0;
+    for (int i = 0; i < event_count; ++i) {
+        if (event_info[i].event_no) continue;
+        event_info[i].event_no = next_event_no++;
+        numbered = 1;
+    }
+    save_counters();
+    return numbered;
+}
+
+void booking_ids_move(const char *path) {
+    snprintf(counters_path, sizeof(counters_path), "%s", path);
+    save_counters();
+}
+
+unsigned int next_event_number(void) {
+    if (next_event_no > MAX_EVENT_NUMBER) {
+        fprintf(stderr, "Fatal: event numbers exhausted\n");
+        exit(1);
+    }
+    unsigned int no = next_event_no++;
+    save_counters();
+    return no;
+}
+
+/* ============= ENCODE / DECODE ============= */
+
+void new_booking_id(int event_idx, char *out) {
+    if (next_seq >= reserved_seq) {
+        reserved_seq = next_seq + BOOKING_SEQ_BLOCK;
+        save_counters();
+    }
+    uint64_t seq = next_seq++;
+    uint64_t v = ((uint64_t)(booking_shard & 0xF) << (SEQ_BITS + EVENT_BITS))
+               | ((seq & ((1ULL << SEQ_BITS) - 1)) << EVENT_BITS)
+               | (event_info[event_idx].event_no & MAX_EVENT_NUMBER);
+    out[0] = 'B';
+    out[1] = 'K';
+    for (int i = ID_DIGITS - 1; i >= 0; --i) {
+        out[2 + i] = digits[v & 31];
+        v >>= 5;
+    }
+    out[BOOKING_ID_LEN] = '\0';
+}
+
+int booking_id_decode(const char *id, unsigned int *shard, uint64_t *seq, unsigned int *event_no) {
+    if (id[0] != 'B' || id[1] != 'K') return 0;
+    uint64_t v = 0;
+    for (int i = 0; i < ID_DIGITS; ++i) {
+        int d = digit_value(id[2 + i]);
+        if (d < 0) return 0;
+        /* 13 digits hold 65 bits; the first may only carry 4 */
+        if (i == 0 && d > 15) return 0;
+        v = (v << 5) | (uint64_t)d;
+    }
+    if (id[BOOKING_ID_LEN] != '\0') return 0;
+    *shard = (unsigned int)(v >> (SEQ_BITS + EVENT_BITS));
+    *seq = (v >> EVENT_BITS) & ((1ULL << SEQ_BITS) - 1);
+    *event_no = (unsigned int)(v & MAX_EVENT_NUMBER);
+    return *event_no != 0;
+}
+
+int event_by_number(unsigned int event_no) {
+    for (int i = 0; i < event_count; ++i)
+        if (event_info[i].event_no == event_no) return i;
+    return -1;
+}
@@ -0,0 +1,42 @@
+#ifndef BOOKID_H
+#define BOOKID_H
+
+#include <stdint.h>
+
+/* Booking IDs. Each is a 64-bit value, shard (4 bits) | sequence (36 bits)
+ * | event number (24 bits), written as "BK" and 13 base32 digits. IDs sort
+ * in the order they were issued and decode to their event without any
+ * lookup. Event numbers are stable, unlike positions in events[] which
+ * shift when an event is deleted or archived. The next event number and
+ * the sequence high-water mark live in a small counters file; sequences
+ * are reserved from it a block at a time, so a restart skips the rest of
+ * the last block rather than reissue an ID. */
+
+#define BOOKING_ID_LEN 15          /* "BK" + 13 digits */
+#define BOOKING_SEQ_BLOCK 4096     /* sequences reserved per counters write */
+#define MAX_EVENT_NUMBER 0xFFFFFF
+
+extern int booking_shard;          /* 0-15 */
+
+/* Read the counters file and number any event loaded without a number;
+ * call once events.txt has been loaded. Returns 1 if events were
+ * numbered (events.txt needs saving). */
+int booking_ids_load(const char *path);
+
+/* Keep the counters in path from now on, writing them there at once */
+void booking_ids_move(const char *path);
+
+/* A new event number, persisted before it is returned */
+unsigned int next_event_number(void);
+
+/* A new booking ID for the event into out (BOOKING_ID_LEN + 1 bytes) */
+void new_booking_id(int event_idx, char *out);
+
+/* Split an ID into its parts. Returns 0 for anything that is not a
+ * well-formed ID, including IDs from before this scheme. */
+int booking_id_decode(const char *id, unsigned int *shard, uint64_t *seq, unsigned int *event_no);
+
+/* Position in events[] of the event with this number, or -1 */
+int event_by_number(unsigned int event_no);
+
+#endif /* BOOKID_H */
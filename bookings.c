@@ -1,12 +1,25 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <ctype.h>
 #include <time.h>
 #include "bookings.h"
 #include "utils.h"
+#include "persist.h"
+#include "journal.h"
+#include "allocator.h"
+#include "columns.h"
+#include "workers.h"
+#include "archive.h"
+#include "waitroom.h"
+#include "purchase.h"
+#include "ratelimit.h"
+#include "dedup.h"
+#include "bookid.h"
+#include "txn.h"
 
-static int booking_counter = 1;  /* Global counter for unique booking IDs */
+#define MAX_SEARCH_RESULTS 200  /* matching seats printed per search */
 
 /* ============= PRIORITY QUEUE (MIN-HEAP) IMPLEMENTATION ============= */
 
@@ -103,12 +116,10 @@ int pq_extract_min(PriorityQueue *pq, char *out_username, char *out_phone, char
     return 1;
 }
 
-/* ============= BOOKING ID GENERATION ============= */
-
-void generate_booking_id(char *out_id, int event_idx, int booking_num) {
-    time_t now = time(NULL);
-    snprintf(out_id, 32, "BK%d-E%d-%ld", booking_num, event_idx, (long)now % 100000);
-    booking_counter++;
+/* Seat label ("A1" or "FLOOR-A1") for a booking */
+void booking_seat_label(const Booking *b, char *out, size_t n) {
+    SeatRef s = { b->section, b->row, b->col };
+    format_seat_label(events[b->event_id].layout, s, out, n);
 }
 
 /* ============= REFUND POLICY ============= */
@@ -120,6 +131,16 @@ double calculate_refund(double price_paid) {
     return price_paid * (refund_percent / 100.0);
 }
 
+/* ============= JOURNAL RECORDS ============= */
+
+/* One booking in bookings.txt record format */
+void format_booking_record(TextBuf *tb, const Booking *b) {
+    /* Format: event_id|username|display_name|phone|email|row|col|price_paid|booking_id|timestamp|num_seats|section */
+    tb_printf(tb, "%d|%s|%s|%s|%s|%d|%d|%.2f|%s|%ld|%d|%d\n",
+            b->event_id, b->username, b->display_name, b->phone, b->email,
+            b->row, b->col, b->price_paid, b->booking_id, (long)b->timestamp, b->num_seats, b->section);
+}
+
 /* ============= EXISTING FUNCTIONS (updated) ============= */
 
 static double apply_discount_event(double base_price, const char *entered, const char *event_code, int event_percent) {
@@ -136,28 +157,31 @@ static double apply_discount_event(double base_price, const char *entered, const
 
 void show_all_bookings_for_event(int event_idx) {
     if (event_idx < 0 || event_idx >= event_count) return;
+    event_materialize(event_idx);
     Booking *b = events[event_idx].bookings_head;
-    printf("\nBookings for %s:\n", events[event_idx].name);
+    printf("\nBookings for %s:\n", event_info[event_idx].name);
     if (!b) { printf(" (none)\n"); return; }
     while (b) {
-        char time_str[26];
+        char time_str[26], seat[MAX_SEAT_LABEL];
         struct tm *tm_info = localtime(&b->timestamp);
         strftime(time_str, 26, "%Y-%m-%d %H:%M", tm_info);
-        printf(" - ID: %s | %s | seat %c%d | Rs.%.2f | %s | phone: %s\n", 
-               b->booking_id, b->username, 'A' + b->row, b->col + 1, b->price_paid, time_str, b->phone);
+        booking_seat_label(b, seat, sizeof(seat));
+        printf(" - ID: %s | %s | seat %s | Rs.%.2f | %s | phone: %s\n", 
+               b->booking_id, b->username, seat, b->price_paid, time_str, b->phone);
         b = b->next;
     }
 }
 
 void show_waiting_queue(int event_idx) {
     if (event_idx < 0 || event_idx >= event_count) return;
+    event_materialize(event_idx);
     PriorityQueue *pq = events[event_idx].wait_queue;
-    Event *ev = &events[event_idx];
+    const EventInfo *info = &event_info[event_idx];
     
     printf("\n+============================================================+\n");
-    printf("|  WAITING QUEUE - %s\n", ev->name);
+    printf("|  WAITING QUEUE - %s\n", info->name);
     printf("+============================================================+\n");
-    printf("Event: %s - %s @ %s\n", ev->name, ev->event_date, ev->event_time);
+    printf("Event: %s - %s @ %s\n", info->name, info->event_date, info->event_time);
     printf("People waiting: %d\n", pq->size);
     
     if (pq_is_empty(pq)) { 
@@ -174,31 +198,75 @@ void show_waiting_queue(int event_idx) {
     }
 }
 
+typedef struct ListingBuckets {
+    const int *start;   /* per event, into order[] */
+    const int *order;   /* live column entries grouped by event */
+} ListingBuckets;
+
+static void render_event_listing(int e, TextBuf *tb, void *ctx) {
+    const ListingBuckets *lb = (const ListingBuckets *)ctx;
+    const BookingColumns *c = &booking_cols;
+    tb_printf(tb, "\nBookings for %s:\n", event_info[e].name);
+    if (lb->start[e] == lb->start[e + 1]) { tb_printf(tb, " (none)\n"); return; }
+    for (int j = lb->start[e + 1] - 1; j >= lb->start[e]; --j) {
+        int i = lb->order[j];
+        char time_str[26], seat[MAX_SEAT_LABEL];
+        struct tm tm_info;
+        time_t ts = (time_t)c->timestamp[i];
+        strftime(time_str, 26, "%Y-%m-%d %H:%M", localtime_r(&ts, &tm_info));
+        SeatRef sr = { c->section[i], c->row[i], c->col[i] };
+        format_seat_label(events[e].layout, sr, seat, sizeof(seat));
+        tb_printf(tb, " - ID: %s | %s | seat %s | Rs.%.2f | %s | phone: %s\n",
+                  c->groups.names[c->group[i]], c->users.names[c->user[i]], seat, c->price[i],
+                  time_str, c->phones.names[c->phone[i]]);
+    }
+}
+
+/* Lists every event from the columnar copy: live entries are bucketed by
+ * event in one counting pass, then each event's listing is rendered on
+ * the worker pool, newest booking first */
 void show_all_bookings_admin(void) {
+    materialize_all_events();
     printf("\n=== All Bookings Across Events ===\n");
-    for (int e = 0; e < event_count; ++e) show_all_bookings_for_event(e);
+    const BookingColumns *c = &booking_cols;
+    int *start = (int *)calloc((size_t)event_count + 1, sizeof(int));
+    int *fill = (int *)malloc(sizeof(int) * ((size_t)event_count + 1));
+    int *order = (int *)malloc(sizeof(int) * ((size_t)c->count + 1));
+    if (!start || !fill || !order) {
+        free(start); free(fill); free(order);
+        for (int e = 0; e < event_count; ++e) show_all_bookings_for_event(e);
+        return;
+    }
+    for (int i = 0; i < c->count; ++i) start[c->event[i] + 1] += c->live[i];
+    for (int e = 0; e < event_count; ++e) start[e + 1] += start[e];
+    memcpy(fill, start, sizeof(int) * (size_t)event_count);
+    for (int i = 0; i < c->count; ++i) if (c->live[i]) order[fill[c->event[i]]++] = i;
+
+    ListingBuckets lb = { start, order };
+    parallel_render(event_count, render_event_listing, &lb, stdout);
+    free(start);
+    free(fill);
+    free(order);
+}
+
+static void render_event_map(int e, TextBuf *tb, void *ctx) {
+    (void)ctx;
+    render_seat_map(e, tb);
 }
 
 void show_full_seatmap_all_events(void) {
-    for (int e = 0; e < event_count; ++e) display_seat_map(e);
+    materialize_all_events();
+    parallel_render(event_count, render_event_map, NULL, stdout);
 }
 
-int auto_assign_seat(int event_idx, int *out_row, int *out_col) {
-    if (event_idx < 0 || event_idx >= event_count) return 0;
-    Event *ev = &events[event_idx];
-    for (int r = 0; r < ev->rows; ++r) {
-        for (int c = 0; c < ev->cols; ++c) {
-            int idx = seat_index(ev, r, c);
-            if (!ev->seats[idx]) { *out_row = r; *out_col = c; return 1; }
-        }
-    }
-    return 0;
+int auto_assign_seat(int event_idx, SeatRef *out) {
+    return auto_assign_multiple_seats(event_idx, 1, out);
 }
 
 static void enqueue_waiting(int event_idx, const User *user, int num_seats) {
     Event *ev = &events[event_idx];
     pq_insert(ev->wait_queue, user->username, user->phone, user->email, num_seats);
-    printf("Added to waiting queue for %s (requested %d seat%s).\n", ev->name, num_seats, num_seats > 1 ? "s" : "");
+    printf("Added to waiting queue for %s (requested %d seat%s).\n", event_info[event_idx].name, num_seats, num_seats > 1 ? "s" : "");
 }
 
 static int dequeue_waiting(int event_idx, char *out_username, char *out_phone, char *out_email, int *out_num_seats) {
@@ -206,64 +274,153 @@ static int dequeue_waiting(int event_idx, char *out_username, char *out_phone, c
     return pq_extract_min(ev->wait_queue, out_username, out_phone, out_email, out_num_seats);
 }
 
+/* Offer freed seats to the head of the waiting queue, booking what is
+ * free now and re-queuing the rest */
+static void promote_waiting(int event_idx) {
+    Event *ev = &events[event_idx];
+    Booking tmpl;
+    int requested_seats = 0;
+    memset(&tmpl, 0, sizeof(tmpl));
+    if (!dequeue_waiting(event_idx, tmpl.username, tmpl.phone, tmpl.email, &requested_seats)) return;
+    /* Waiting customers are held to the purchase limits too */
+    int allowance = purchase_allowance(event_idx, tmpl.username, tmpl.phone);
+    if (requested_seats > allowance) requested_seats = allowance;
+    if (requested_seats == 0) {
+        printf("  -> %s is at the purchase limit; removed from the waiting queue\n", tmpl.username);
+        return;
+    }
+    SeatRef seats[10];
+    double prices[10];
+    int seats_available = get_available_seat_count(event_idx);
+    int seats_to_book = (requested_seats <= seats_available) ? requested_seats : seats_available;
+    Txn txn;
+    txn_begin(&txn);
+    int booked = 0;
+    if (seats_to_book > 0 && auto_assign_multiple_seats(event_idx, seats_to_book, seats)) {
+        snprintf(tmpl.display_name, sizeof(tmpl.display_name), "%s", tmpl.username);
+        new_booking_id(event_idx, tmpl.booking_id);
+        tmpl.event_id = event_idx;
+        tmpl.timestamp = time(NULL);
+        for (int j = 0; j < seats_to_book; j++) prices[j] = event_seat_price(ev, seats[j]);
+        booked = txn_book(&txn, &tmpl, seats, prices, seats_to_book);
+    }
+    if (!booked) {
+        printf("  -> Re-queuing %s (seats not yet available)\n", tmpl.username);
+        pq_insert(ev->wait_queue, tmpl.username, tmpl.phone, tmpl.email, requested_seats);
+        return;
+    }
+    if (!txn_commit(&txn)) {
+        printf("  -> Could not save seats for %s; kept in the waiting queue\n", tmpl.username);
+        pq_insert(ev->wait_queue, tmpl.username, tmpl.phone, tmpl.email, requested_seats);
+        return;
+    }
+    printf("  -> Assigned %d seat%s to waiting customer: %s (%s)\n",
+           seats_to_book, seats_to_book > 1 ? "s" : "", tmpl.username, tmpl.phone);
+    /* If not all seats could be assigned, re-queue for remaining */
+    if (seats_to_book < requested_seats) {
+        printf("  -> Re-queuing %s for remaining %d seat%s\n",
+               tmpl.username, requested_seats - seats_to_book,
+               (requested_seats - seats_to_book) > 1 ? "s" : "");
+        pq_insert(ev->wait_queue, tmpl.username, tmpl.phone, tmpl.email, requested_seats - seats_to_book);
+    }
+}
+
+/* One line describing the booking whose newest seat is head, for a
+ * retried request */
+static void summarize_booking(const Booking *head, char *out, size_t n) {
+    size_t used = (size_t)snprintf(out, n, "Booking ID: %s | Seats:", head->booking_id);
+    double total = 0.0;
+    for (const Booking *b = head; b && strcmp(b->booking_id, head->booking_id) == 0; b = b->next) {
+        char label[MAX_SEAT_LABEL];
+        booking_seat_label(b, label, sizeof(label));
+        if (used < n) used += (size_t)snprintf(out + used, n - used, " [%s]", label);
+        total += b->price_paid;
+    }
+    if (used < n) snprintf(out + used, n - used, " | Total Paid: Rs.%.2f", total);
+}
+
+/* Print the stored result of a retried request; returns whether there was one */
+static int replay_request(const char *scope, const char *key, int *code) {
+    const DedupResult *done = dedup_lookup(scope, key);
+    if (!done) return 0;
+    printf("Request %s was already processed:\n  %s\n", key, done->summary);
+    *code = done->code;
+    return 1;
+}
+
+/* A retry with the same request reference gets the first result back.
+ * During an on-sale the customer then waits their turn in the event's
+ * virtual queue; the pass they get is handed back once they are done. */
 int book_seat_for_user(int event_idx, User *user) {
+    if (event_idx < 0 || event_idx >= event_count) { printf("Invalid event.\n"); return 0; }
+    char key[DEDUP_MAX_KEY], scope[MAX_USERNAME + 8];
+    int res = 0;
+    read_request_key(key, sizeof(key));
+    snprintf(scope, sizeof(scope), "book:%s", user->username);
+    if (replay_request(scope, key, &res)) return res;
+    waitroom_wait_turn(event_idx, user->username);
     printf("\nHow many seats would you like to book? (1-10): ");
     int num_seats = read_int();
-    if (num_seats < 1 || num_seats > 10) {
-        printf("Invalid number. Please choose 1-10 seats.\n");
-        return 0;
+    if (num_seats < 1 || num_seats > 10) printf("Invalid number. Please choose 1-10 seats.\n");
+    else res = book_multiple_seats_for_user(event_idx, user, num_seats);
+    waitroom_leave(event_idx, user->username);
+
+    char summary[DEDUP_MAX_SUMMARY];
+    if (res == 1) {
+        summarize_booking(events[event_idx].bookings_head, summary, sizeof(summary));
+        dedup_remember(scope, key, res, summary);
+    } else if (res == 2) {
+        snprintf(summary, sizeof(summary), "Added to the waiting queue for %s (%d seat%s)",
+                 event_info[event_idx].name, num_seats, num_seats > 1 ? "s" : "");
+        dedup_remember(scope, key, res, summary);
     }
-    return book_multiple_seats_for_user(event_idx, user, num_seats);
+    return res;
 }
 
-int auto_assign_multiple_seats(int event_idx, int num_seats, int rows_out[], int cols_out[]) {
+int auto_assign_multiple_seats(int event_idx, int num_seats, SeatRef seats_out[]) {
     if (event_idx < 0 || event_idx >= event_count) return 0;
     Event *ev = &events[event_idx];
+    const VenueLayout *v = ev->layout;
+    if (num_seats < 1 || ev->occ.booked + num_seats > v->total_seats) return 0;
     
-    /* Try to find adjacent seats in the same row first */
-    for (int r = 0; r < ev->rows; ++r) {
-        int consecutive = 0;
-        int start_col = -1;
-        for (int c = 0; c < ev->cols; ++c) {
-            if (!ev->seats[seat_index(ev, r, c)]) {
-                if (consecutive == 0) start_col = c;
-                consecutive++;
-                if (consecutive == num_seats) {
-                    /* Found enough consecutive seats */
-                    for (int i = 0; i < num_seats; ++i) {
-                        rows_out[i] = r;
-                        cols_out[i] = start_col + i;
-                    }
-                    return 1;
-                }
-            } else {
-                consecutive = 0;
-            }
+    /* Best-scoring block of adjacent seats in one row */
+    SeatRef first;
+    if (num_seats <= MAX_GROUP_SEATS && alloc_best_block(ev->alloc, v, &ev->occ, num_seats, &first)) {
+        for (int i = 0; i < num_seats; ++i) {
+            seats_out[i] = first;
+            seats_out[i].col = first.col + i;
         }
+        return 1;
     }
     
-    /* If no consecutive seats found, just assign any available */
-    int assigned = 0;
-    for (int r = 0; r < ev->rows && assigned < num_seats; ++r) {
-        for (int c = 0; c < ev->cols && assigned < num_seats; ++c) {
-            if (!ev->seats[seat_index(ev, r, c)]) {
-                rows_out[assigned] = r;
-                cols_out[assigned] = c;
-                assigned++;
-            }
-        }
-    }
-    return (assigned == num_seats);
+    /* Then a compact block over adjacent rows, e.g. 3+3 */
+    if (alloc_best_area(v, &ev->occ, num_seats, seats_out)) return 1;
+    
+    /* Nothing clustered left: the best individual seats by rank */
+    return alloc_best_seats(v, &ev->occ, num_seats, seats_out);
 }
 
 int book_multiple_seats_for_user(int event_idx, User *user, int num_seats) {
     if (event_idx < 0 || event_idx >= event_count) { printf("Invalid event.\n"); return 0; }
     if (event_count == 0) { printf("No events available at the moment. Please check later.\n"); return 0; }
+    /* Floods are turned away before they touch seat state */
+    if (!rate_allow(RATE_BOOK_USER, user->username) || !rate_allow(RATE_BOOK_PHONE, user->phone) ||
+        !rate_allow(RATE_BOOK_SESSION, rate_session_key())) {
+        printf("Too many booking attempts. Please wait a minute and try again.\n");
+        return 0;
+    }
 
+    event_materialize(event_idx);
+    int allowed = purchase_allowance(event_idx, user->username, user->phone);
+    if (num_seats > allowed) {
+        if (allowed == 0) printf("You have reached the purchase limit for this event.\n");
+        else printf("Purchase limit: you can book %d more seat%s for this event.\n", allowed, allowed > 1 ? "s" : "");
+        return 0;
+    }
     display_seat_map(event_idx);
     
     Event *ev = &events[event_idx];
-    int rows[10], cols[10];  /* max 10 seats */
+    SeatRef seats[10];  /* max 10 seats */
     int original_num_seats = num_seats;  /* Track original request */
     int is_partial_booking = 0;  /* Flag for partial booking */
     
@@ -273,42 +430,33 @@ int book_multiple_seats_for_user(int event_idx, User *user, int num_seats) {
     
     if (choice == 1) {
         /* Manual seat selection */
-        printf("\nEnter %d seat(s) (format: A1, B3, etc.):\n", num_seats);
+        if (ev->layout->section_count > 1) printf("\nEnter %d seat(s) (format: SECTION-A1, e.g. %s-B3):\n", num_seats, ev->layout->sections[0].name);
+        else printf("\nEnter %d seat(s) (format: A1, B3, etc.):\n", num_seats);
         for (int i = 0; i < num_seats; ++i) {
             char seat_input[16];
             printf("Seat %d: ", i + 1);
             read_line(seat_input, sizeof(seat_input));
             
-            if (strlen(seat_input) < 2) { 
-                printf("Invalid seat input. Booking cancelled.\n"); 
-                return 0; 
-            }
-            
-            char rch = toupper((unsigned char)seat_input[0]);
-            int cnum = atoi(seat_input + 1);
-            int row = rch - 'A';
-            int col = cnum - 1;
-            
-            if (row < 0 || row >= ev->rows || col < 0 || col >= ev->cols) { 
+            SeatRef seat;
+            if (!parse_seat_label(ev->layout, seat_input, &seat)) { 
                 printf("Seat %s out of range. Booking cancelled.\n", seat_input); 
                 return 0; 
             }
             
-            if (ev->seats[seat_index(ev, row, col)]) { 
+            if (event_seat_taken(ev, seat)) { 
                 printf("Seat %s already booked. Booking cancelled.\n", seat_input); 
                 return 0; 
             }
             
             /* Check for duplicates */
             for (int j = 0; j < i; ++j) {
-                if (rows[j] == row && cols[j] == col) {
+                if (seats[j].section == seat.section && seats[j].row == seat.row && seats[j].col == seat.col) {
                     printf("You already selected seat %s. Booking cancelled.\n", seat_input);
                     return 0;
                 }
             }
             
-            rows[i] = row;
-            cols[i] = col;
+            seats[i] = seat;
         }
     } else if (choice == 2) {
         /* Auto-assign seats */
@@ -335,7 +483,7 @@ int book_multiple_seats_for_user(int event_idx, User *user, int num_seats) {
             
             if (partial_choice == 1) {
                 /* Book available seats, queue for rest */
-                if (!auto_assign_multiple_seats(event_idx, available, rows, cols)) {
+                if (!auto_assign_multiple_seats(event_idx, available, seats)) {
                     printf("Error assigning seats.\n");
                     return 0;
                 }
@@ -352,7 +500,7 @@ int book_multiple_seats_for_user(int event_idx, User *user, int num_seats) {
             }
         } else {
             /* Enough seats available */
-            if (!auto_assign_multiple_seats(event_idx, num_seats, rows, cols)) {
+            if (!auto_assign_multiple_seats(event_idx, num_seats, seats)) {
                 printf("Error assigning seats.\n");
                 return 0;
             }
@@ -363,9 +511,11 @@ int book_multiple_seats_for_user(int event_idx, User *user, int num_seats) {
     }
     
     /* Show selected seats */
+    char label[MAX_SEAT_LABEL];
     printf("\nSelected seats: ");
     for (int i = 0; i < num_seats; ++i) {
-        printf("[%c%d] ", 'A' + rows[i], cols[i] + 1);
+        format_seat_label(ev->layout, seats[i], label, sizeof(label));
+        printf("[%s] ", label);
     }
     printf("\n");
 
@@ -373,49 +523,58 @@ int book_multiple_seats_for_user(int event_idx, User *user, int num_seats) {
     printf("Enter discount code (or NA if none): ");
     read_line(code_entered, sizeof(code_entered));
 
-    double base_price_per_seat = apply_discount_event(ev->base_price, code_entered, ev->discount_code, ev->discount_percent);
-    double total_price = base_price_per_seat * num_seats;
+    /* Each seat is priced by its section's price zone */
+    double seat_prices[10];
+    double total_price = 0.0;
+    for (int i = 0; i < num_seats; ++i) {
+        seat_prices[i] = apply_discount_event(event_seat_price(ev, seats[i]), code_entered,
+                                              event_info[event_idx].discount_code, event_info[event_idx].discount_percent);
+        total_price += seat_prices[i];
+    }
     
-    printf("\nPrice per seat: Rs.%.2f (%.0f%% full)\n", base_price_per_seat, get_occupancy_percent(event_idx));
+    if (ev->layout->section_count > 1) printf("\nAverage price per seat: Rs.%.2f (%.0f%% full)\n", total_price / num_seats, get_occupancy_percent(event_idx));
+    else printf("\nPrice per seat: Rs.%.2f (%.0f%% full)\n", seat_prices[0], get_occupancy_percent(event_idx));
     printf("Total for %d seats: Rs.%.2f\n", num_seats, total_price);
     printf("Confirm booking? (y/n): ");
     char yn2[8];
     read_line(yn2, sizeof(yn2));
     if (!(yn2[0] == 'y' || yn2[0] == 'Y')) { printf("Booking cancelled.\n"); return 0; }
+    if (!waitroom_has_pass(event_idx, user->username)) {
+        printf("Your booking window for this on-sale has closed. Please join the queue again.\n");
+        return 0;
+    }
 
-    /* Create bookings */
-    char booking_id[32];
-    generate_booking_id(booking_id, event_idx, booking_counter);
-    time_t now = time(NULL);
-    
-    for (int i = 0; i < num_seats; ++i) {
-        ev->seats[seat_index(ev, rows[i], cols[i])] = 1;
-        Booking *b = (Booking *)malloc(sizeof(Booking));
-        if (!b) { printf("Memory error.\n"); return 0; }
-        
-        strncpy(b->username, user->username, MAX_USERNAME - 1); b->username[MAX_USERNAME - 1] = '\0';
-        strncpy(b->display_name, user->username, MAX_NAME - 1); b->display_name[MAX_NAME - 1] = '\0';
-        strncpy(b->phone, user->phone, MAX_PHONE - 1); b->phone[MAX_PHONE - 1] = '\0';
-        strncpy(b->email, user->email, MAX_EMAIL - 1); b->email[MAX_EMAIL - 1] = '\0';
-        strncpy(b->booking_id, booking_id, 31); b->booking_id[31] = '\0';
-        b->event_id = event_idx;
-        b->row = rows[i]; b->col = cols[i];
-        b->price_paid = base_price_per_seat;
-        b->timestamp = now;
-        b->num_seats = num_seats;
-        b->next = ev->bookings_head;
-        ev->bookings_head = b;
+    /* Stage every seat first, so a failure leaves nothing half-booked */
+    Booking tmpl;
+    memset(&tmpl, 0, sizeof(tmpl));
+    snprintf(tmpl.username, sizeof(tmpl.username), "%s", user->username);
+    snprintf(tmpl.display_name, sizeof(tmpl.display_name), "%s", user->username);
+    snprintf(tmpl.phone, sizeof(tmpl.phone), "%s", user->phone);
+    snprintf(tmpl.email, sizeof(tmpl.email), "%s", user->email);
+    new_booking_id(event_idx, tmpl.booking_id);
+    tmpl.event_id = event_idx;
+    tmpl.timestamp = time(NULL);
+    Txn txn;
+    txn_begin(&txn);
+    if (!txn_book(&txn, &tmpl, seats, seat_prices, num_seats)) {
+        printf("Could not reserve the selected seats. Booking cancelled.\n");
+        return 0;
     }
-    
-    ev->revenue += total_price;
-    ev->total_bookings++;
+    /* Acknowledge only once the new bookings are durable */
+    if (!txn_commit(&txn)) {
+        printf("\nYour booking could not be saved, so it is not confirmed.\n");
+        printf("Please check your bookings before trying again.\n");
+        return 0;
+    }
+    const char *booking_id = tmpl.booking_id;
     
     printf("\nBooking successful!\n");
     printf("  Booking ID: %s\n", booking_id);
-    printf("  Event: %s\n", ev->name);
+    printf("  Event: %s\n", event_info[event_idx].name);
     printf("  Seats: ");
     for (int i = 0; i < num_seats; ++i) {
-        printf("[%c%d] ", 'A' + rows[i], cols[i] + 1);
+        format_seat_label(ev->layout, seats[i], label, sizeof(label));
+        printf("[%s] ", label);
     }
     printf("\n  Total Paid: Rs.%.2f\n", total_price);
     
@@ -432,19 +591,27 @@ int book_multiple_seats_for_user(int event_idx, User *user, int num_seats) {
 
 int cancel_seat_by_user(int event_idx, const User *user) {
     if (event_idx < 0 || event_idx >= event_count) { printf("Invalid event.\n"); return 0; }
+    char key[DEDUP_MAX_KEY], scope[MAX_USERNAME + 8];
+    int res = 0;
+    read_request_key(key, sizeof(key));
+    snprintf(scope, sizeof(scope), "cancel:%s", user->username);
+    if (replay_request(scope, key, &res)) return res;
+    event_materialize(event_idx);
     Event *ev = &events[event_idx];
     
     /* First, show user's bookings for this event */
-    printf("\n=== Your Tickets for %s ===\n", ev->name);
+    printf("\n=== Your Tickets for %s ===\n", event_info[event_idx].name);
     Booking *b = ev->bookings_head;
     int count = 0;
     Booking *booking_ptrs[100]; /* Store pointers */
     
     while (b) {
-        if (strcmp(b->username, user->username) == 0) {
+        if (strcmp(b->username, user->username) == 0 && count < 100) {
+            char seat[MAX_SEAT_LABEL];
+            booking_seat_label(b, seat, sizeof(seat));
             booking_ptrs[count] = b;
-            printf(" %d) Seat: [%c%d] | Booking ID: %s | Paid: Rs.%.2f\n", 
-                   count + 1, 'A' + b->row, b->col + 1, b->booking_id, b->price_paid);
+            printf(" %d) Seat: [%s] | Booking ID: %s | Paid: Rs.%.2f\n", 
+                   count + 1, seat, b->booking_id, b->price_paid);
             count++;
         }
         b = b->next;
@@ -494,8 +661,10 @@ int cancel_seat_by_user(int event_idx, const User *user) {
     for (int i = 0; i < num_to_cancel; i++) {
         Booking *sel = booking_ptrs[choices[i] - 1];
         double refund = calculate_refund(sel->price_paid);
+        char seat[MAX_SEAT_LABEL];
+        booking_seat_label(sel, seat, sizeof(seat));
         total_refund += refund;
-        printf("  - Seat [%c%d] | Refund: Rs.%.2f\n", 'A' + sel->row, sel->col + 1, refund);
+        printf("  - Seat [%s] | Refund: Rs.%.2f\n", seat, refund);
     }
     printf("Total refund: Rs.%.2f\n", total_refund);
     printf("\nConfirm cancellation? (y/n): ");
@@ -509,123 +678,358 @@ int cancel_seat_by_user(int event_idx, const User *user) {
     /* Process each cancellation */
     printf("\n=== Processing Cancellations ===\n");
     int cancelled_count = 0;
-    
+    double refunded = 0.0;
+    char labels[100][MAX_SEAT_LABEL], ids[100][32];
+    double refunds[100];
+    Txn txn;
+    txn_begin(&txn);
     for (int i = 0; i < num_to_cancel; i++) {
         Booking *selected = booking_ptrs[choices[i] - 1];
-        Booking *prev = NULL, *cur = ev->bookings_head;
-        
-        while (cur) {
-            if (cur == selected) {
-                int r = cur->row, c = cur->col;
-                double refund_amount = calculate_refund(cur->price_paid);
-                
-                printf("\nCancelled: Seat [%c%d] | Booking ID: %s | Refund: Rs.%.2f\n", 
-                       'A' + r, c + 1, cur->booking_id, refund_amount);
-                
-                if (prev) prev->next = cur->next; 
-                else ev->bookings_head = cur->next;
-                free(cur);
-                ev->seats[seat_index(ev, r, c)] = 0;
-                ev->revenue -= refund_amount;
-                cancelled_count++;
-                
-                /* Try to assign to waiting list */
-                char namebuf[MAX_USERNAME], phonebuf[MAX_PHONE], emailbuf[MAX_EMAIL];
-                int requested_seats = 0;
-                if (dequeue_waiting(event_idx, namebuf, phonebuf, emailbuf, &requested_seats)) {
-                    /* Try to auto-assign the requested number of seats */
-                    int temp_rows[10], temp_cols[10];
-                    int seats_available = get_available_seat_count(event_idx);
-                    int seats_to_book = (requested_seats <= seats_available) ? requested_seats : seats_available;
-                    
-                    if (seats_to_book > 0 && auto_assign_multiple_seats(event_idx, seats_to_book, temp_rows, temp_cols)) {
-                        printf("  -> Assigned %d seat%s to waiting customer: %s (%s)\n", 
-                               seats_to_book, seats_to_book > 1 ? "s" : "", namebuf, phonebuf);
-                        
-                        char new_booking_id[32];
-                        generate_booking_id(new_booking_id, event_idx, booking_counter);
-                        
-                        /* Create bookings for all assigned seats */
-                        for (int j = 0; j < seats_to_book; j++) {
-                            Booking *b = (Booking *)malloc(sizeof(Booking));
-                            if (b) {
-                                strncpy(b->username, namebuf, MAX_USERNAME - 1); b->username[MAX_USERNAME - 1] = '\0';
-                                strncpy(b->display_name, namebuf, MAX_NAME - 1); b->display_name[MAX_NAME - 1] = '\0';
-                                strncpy(b->phone, phonebuf, MAX_PHONE - 1); b->phone[MAX_PHONE - 1] = '\0';
-                                strncpy(b->email, emailbuf, MAX_EMAIL - 1); b->email[MAX_EMAIL - 1] = '\0';
-                                strncpy(b->booking_id, new_booking_id, 31); b->booking_id[31] = '\0';
-                                b->event_id = event_idx;
-                                b->row = temp_rows[j]; b->col = temp_cols[j];
-                                b->timestamp = time(NULL);
-                                b->num_seats = seats_to_book;
-                                b->price_paid = ev->base_price;
-                                b->next = ev->bookings_head;
-                                ev->bookings_head = b;
-                                ev->seats[seat_index(ev, temp_rows[j], temp_cols[j])] = 1;
-                                ev->revenue += b->price_paid;
-                            }
-                        }
-                        
-                        /* If not all seats could be assigned, re-queue for remaining */
-                        if (seats_to_book < requested_seats) {
-                            printf("  -> Re-queuing %s for remaining %d seat%s\n", 
-                                   namebuf, requested_seats - seats_to_book, 
-                                   (requested_seats - seats_to_book) > 1 ? "s" : "");
-                            pq_insert(ev->wait_queue, namebuf, phonebuf, emailbuf, requested_seats - seats_to_book);
-                        }
-                    } else {
-                        /* Re-queue if seats couldn't be assigned */
-                        printf("  -> Re-queuing %s (seats not yet available)\n", namebuf);
-                        pq_insert(ev->wait_queue, namebuf, phonebuf, emailbuf, requested_seats);
-                    }
-                }
-                break;
-            }
-            prev = cur;
-            cur = cur->next;
-        }
+        refunds[i] = calculate_refund(selected->price_paid);
+        booking_seat_label(selected, labels[i], sizeof(labels[i]));
+        snprintf(ids[i], sizeof(ids[i]), "%s", selected->booking_id);
+        txn_cancel(&txn, selected, refunds[i]);
+        cancelled_count++;
+        refunded += refunds[i];
     }
+    if (!txn_commit(&txn)) {
+        printf("\nThe cancellation could not be saved, so it is not confirmed.\n");
+        printf("Please check your bookings before trying again.\n");
+        return 0;
+    }
+    for (int i = 0; i < cancelled_count; i++)
+        printf("\nCancelled: Seat [%s] | Booking ID: %s | Refund: Rs.%.2f\n", labels[i], ids[i], refunds[i]);
+    
+    /* Each freed seat gives the waiting queue one turn */
+    for (int i = 0; i < cancelled_count; i++) promote_waiting(event_idx);
     
     if (cancelled_count > 0) {
         printf("\nSuccessfully cancelled %d ticket(s).\n", cancelled_count);
+        char summary[DEDUP_MAX_SUMMARY];
+        snprintf(summary, sizeof(summary), "Cancelled %d ticket(s) for %s | Refund: Rs.%.2f",
+                 cancelled_count, event_info[event_idx].name, refunded);
+        dedup_remember(scope, key, 1, summary);
         return 1;
     }
     return 0;
 }
 
+/* Move one of the user's seats to a free seat, as one transaction: the
+ * new seat keeps the booking ID and the discount paid on the old one */
+int swap_seat_by_user(int event_idx, const User *user) {
+    if (event_idx < 0 || event_idx >= event_count) { printf("Invalid event.\n"); return 0; }
+    char key[DEDUP_MAX_KEY], scope[MAX_USERNAME + 8];
+    int res = 0;
+    read_request_key(key, sizeof(key));
+    snprintf(scope, sizeof(scope), "swap:%s", user->username);
+    if (replay_request(scope, key, &res)) return res;
+    event_materialize(event_idx);
+    Event *ev = &events[event_idx];
+
+    printf("\n=== Your Tickets for %s ===\n", event_info[event_idx].name);
+    Booking *booking_ptrs[100];
+    int count = 0;
+    for (Booking *b = ev->bookings_head; b && count < 100; b = b->next) {
+        if (strcmp(b->username, user->username) != 0) continue;
+        char seat[MAX_SEAT_LABEL];
+        booking_seat_label(b, seat, sizeof(seat));
+        booking_ptrs[count++] = b;
+        printf(" %d) Seat: [%s] | Booking ID: %s | Paid: Rs.%.2f\n", count, seat, b->booking_id, b->price_paid);
+    }
+    if (count == 0) {
+        printf("You have no bookings for this event.\n");
+        return 0;
+    }
+    printf("\nTicket to move (1-%d, or 0 to go back): ", count);
+    int ch = read_int();
+    if (ch < 1 || ch > count) { printf("Swap aborted.\n"); return 0; }
+    Booking *old = booking_ptrs[ch - 1];
+
+    char seat_input[16], old_label[MAX_SEAT_LABEL], new_label[MAX_SEAT_LABEL];
+    printf("New seat: ");
+    read_line(seat_input, sizeof(seat_input));
+    SeatRef seat;
+    if (!parse_seat_label(ev->layout, seat_input, &seat)) { printf("Seat %s out of range.\n", seat_input); return 0; }
+    if (event_seat_taken(ev, seat)) { printf("Seat %s already booked.\n", seat_input); return 0; }
+    SeatRef old_seat = { old->section, old->row, old->col };
+    double list_old = event_seat_price(ev, old_seat);
+    double price = event_seat_price(ev, seat);
+    if (list_old > 0) price *= old->price_paid / list_old;
+    booking_seat_label(old, old_label, sizeof(old_label));
+    format_seat_label(ev->layout, seat, new_label, sizeof(new_label));
+
+    printf("\nMove [%s] -> [%s]\n", old_label, new_label);
+    if (price >= old->price_paid) printf("Amount due: Rs.%.2f\n", price - old->price_paid);
+    else printf("Amount refunded: Rs.%.2f\n", old->price_paid - price);
+    printf("Confirm swap? (y/n): ");
+    char yn[8];
+    read_line(yn, sizeof(yn));
+    if (!(yn[0] == 'y' || yn[0] == 'Y')) { printf("Swap aborted.\n"); return 0; }
+
+    Booking tmpl = *old;
+    Txn txn;
+    txn_begin(&txn);
+    if (!txn_book(&txn, &tmpl, &seat, &price, 1)) {
+        printf("Could not reserve seat %s. Swap aborted.\n", new_label);
+        return 0;
+    }
+    txn_cancel(&txn, old, old->price_paid);
+    if (!txn_commit(&txn)) {
+        printf("\nThe swap could not be saved, so it is not confirmed.\n");
+        printf("Please check your bookings before trying again.\n");
+        return 0;
+    }
+
+    char summary[DEDUP_MAX_SUMMARY];
+    snprintf(summary, sizeof(summary), "Moved booking %s from [%s] to [%s]", tmpl.booking_id, old_label, new_label);
+    printf("\n%s.\n", summary);
+    dedup_remember(scope, key, 1, summary);
+    return 1;
+}
+
+/* Choose, price and stage the seats of both events; the caller holds the
+ * waiting-room passes. Returns 1 once both bookings are durable. */
+static int book_event_pair(const int pair[2], const User *user, char ids[2][32], char *summary, size_t summary_len) {
+    SeatRef seats[2][10];
+    double prices[2][10];
+    int counts[2];
+    for (int k = 0; k < 2; ++k) {
+        int e = pair[k];
+        event_materialize(e);
+        printf("Seats for %s (1-10): ", event_info[e].name);
+        counts[k] = read_int();
+        if (counts[k] < 1 || counts[k] > 10) { printf("Invalid number. Please choose 1-10 seats.\n"); return 0; }
+        int allowed = purchase_allowance(e, user->username, user->phone);
+        if (counts[k] > allowed) { printf("Purchase limit: you can book %d more seat%s for %s.\n", allowed, allowed == 1 ? "" : "s", event_info[e].name); return 0; }
+        if (get_available_seat_count(e) < counts[k] || !auto_assign_multiple_seats(e, counts[k], seats[k])) {
+            printf("Not enough seats left for %s.\n", event_info[e].name);
+            return 0;
+        }
+    }
+
+    char code_entered[64];
+    printf("Enter discount code (or NA if none): ");
+    read_line(code_entered, sizeof(code_entered));
+    double total = 0.0;
+    printf("\n");
+    for (int k = 0; k < 2; ++k) {
+        int e = pair[k];
+        char label[MAX_SEAT_LABEL];
+        printf("%s: ", event_info[e].name);
+        for (int i = 0; i < counts[k]; ++i) {
+            prices[k][i] = apply_discount_event(event_seat_price(&events[e], seats[k][i]), code_entered,
+                                                event_info[e].discount_code, event_info[e].discount_percent);
+            total += prices[k][i];
+            format_seat_label(events[e].layout, seats[k][i], label, sizeof(label));
+            printf("[%s] ", label);
+        }
+        printf("\n");
+    }
+    printf("Total for both events: Rs.%.2f\n", total);
+    printf("Confirm booking? (y/n): ");
+    char yn[8];
+    read_line(yn, sizeof(yn));
+    if (!(yn[0] == 'y' || yn[0] == 'Y')) { printf("Booking cancelled.\n"); return 0; }
+    if (!waitroom_has_pass(pair[0], user->username) || !waitroom_has_pass(pair[1], user->username)) {
+        printf("Your booking window for this on-sale has closed. Please join the queue again.\n");
+        return 0;
+    }
+
+    Booking tmpl;
+    memset(&tmpl, 0, sizeof(tmpl));
+    snprintf(tmpl.username, sizeof(tmpl.username), "%s", user->username);
+    snprintf(tmpl.display_name, sizeof(tmpl.display_name), "%s", user->username);
+    snprintf(tmpl.phone, sizeof(tmpl.phone), "%s", user->phone);
+    snprintf(tmpl.email, sizeof(tmpl.email), "%s", user->email);
+    tmpl.timestamp = time(NULL);
+    Txn txn;
+    txn_begin(&txn);
+    for (int k = 0; k < 2; ++k) {
+        new_booking_id(pair[k], tmpl.booking_id);
+        tmpl.event_id = pair[k];
+        if (!txn_book(&txn, &tmpl, seats[k], prices[k], counts[k])) {
+            txn_rollback(&txn);
+            printf("Could not reserve the seats. Nothing was booked.\n");
+            return 0;
+        }
+        strcpy(ids[k], tmpl.booking_id);
+    }
+    if (!txn_commit(&txn)) {
+        printf("\nYour booking could not be saved, so it is not confirmed.\n");
+        printf("Please check your bookings before trying again.\n");
+        return 0;
+    }
+    snprintf(summary, summary_len, "Booked %s (%.40s) and %s (%.40s) | Total: Rs.%.2f",
+             ids[0], event_info[pair[0]].name, ids[1], event_info[pair[1]].name, total);
+    return 1;
+}
+
+/* Book seats at two events together (a double bill, say): both bookings
+ * are staged in one transaction and journaled as one record, so either
+ * both are made or neither is */
+int book_two_events_for_user(int first, int second, User *user) {
+    if (first < 0 || first >= event_count || second < 0 || second >= event_count || first == second) {
+        printf("Choose two different events.\n");
+        return 0;
+    }
+    char key[DEDUP_MAX_KEY], scope[MAX_USERNAME + 8];
+    int res = 0;
+    read_request_key(key, sizeof(key));
+    snprintf(scope, sizeof(scope), "pair:%s", user->username);
+    if (replay_request(scope, key, &res)) return res;
+    if (!rate_allow(RATE_BOOK_USER, user->username) || !rate_allow(RATE_BOOK_PHONE, user->phone) ||
+        !rate_allow(RATE_BOOK_SESSION, rate_session_key())) {
+        printf("Too many booking attempts. Please wait a minute and try again.\n");
+        return 0;
+    }
+    int pair[2] = { first, second };
+    waitroom_wait_turn(first, user->username);
+    waitroom_wait_turn(second, user->username);
+    char ids[2][32], summary[DEDUP_MAX_SUMMARY];
+    res = book_event_pair(pair, user, ids, summary, sizeof(summary));
+    waitroom_leave(first, user->username);
+    waitroom_leave(second, user->username);
+    if (res) {
+        printf("\nBooking successful!\n  %s\n", summary);
+        dedup_remember(scope, key, res, summary);
+    }
+    return res;
+}
+
+static int cmp_column_entries(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    if (booking_cols.event[x] != booking_cols.event[y]) return booking_cols.event[x] - booking_cols.event[y];
+    return y - x;  /* newest first within an event */
+}
+
+/* Live column entries from a set of index posting lists, by event then
+ * newest first. Returns a malloc'd index array (NULL if none). */
+static int *collect_postings(const SlotList *const *lists, int nlists, int *count) {
+    const BookingColumns *c = &booking_cols;
+    *count = 0;
+    int n = 0;
+    for (int l = 0; l < nlists; ++l) n += lists[l]->count;
+    if (n == 0) return NULL;
+    int *idx = (int *)malloc(sizeof(int) * (size_t)n);
+    if (!idx) return NULL;
+    int j = 0;
+    for (int l = 0; l < nlists; ++l) {
+        for (int k = 0; k < lists[l]->count; ++k) {
+            if (c->live[lists[l]->slots[k]]) idx[j++] = lists[l]->slots[k];
+        }
+    }
+    qsort(idx, (size_t)j, sizeof(int), cmp_column_entries);
+    *count = j;
+    if (j == 0) { free(idx); return NULL; }
+    return idx;
+}
+
+/* Entries for one dictionary key (exact username, phone or booking ID) */
+static int *collect_key_matches(const StrDict *d, const char *key, int *count) {
+    const SlotList *list = columns_lookup(d, key);
+    *count = 0;
+    return list ? collect_postings(&list, 1, count) : NULL;
+}
+
+/* Entries for every phone number starting or ending with part */
+static int *collect_phone_matches(const char *part, int suffix, int *count) {
+    const int *ids;
+    int nphones = columns_match_phones(part, suffix, &ids);
+    *count = 0;
+    if (nphones == 0) return NULL;
+    const SlotList **lists = (const SlotList **)malloc(sizeof(SlotList *) * (size_t)nphones);
+    if (!lists) return NULL;
+    for (int i = 0; i < nphones; ++i) lists[i] = &booking_cols.phones.postings[ids[i]];
+    int *idx = collect_postings(lists, nphones, count);
+    free(lists);
+    return idx;
+}
+
+static Booking *scan_snapshot_bookings(int event_idx, int (*match)(const Booking *, const void *),
+                                       const void *arg, int *count);
+
+static int booking_of_user(const Booking *b, const void *arg) {
+    return strcmp(b->username, (const char *)arg) == 0;
+}
+
+/* Loaded events answer from the columns and the rest from their snapshot
+ * ranges, so listing a customer's bookings materializes nothing */
+int visit_user_bookings(const char *username, void (*visit)(const Booking *b, void *ctx), void *ctx) {
+    const BookingColumns *c = &booking_cols;
+    int n, j = 0, visited = 0;
+    int *idx = collect_key_matches(&c->users, username, &n);
+    for (int e = 0; e < event_count; ++e) {
+        if (events[e].materialized) {
+            for (; j < n && c->event[idx[j]] == e; ++j, ++visited) visit(c->ref[idx[j]], ctx);
+            continue;
+        }
+        int m;
+        Booking *cold = scan_snapshot_bookings(e, booking_of_user, username, &m);
+        for (int k = 0; k < m; ++k) visit(&cold[k], ctx);
+        visited += m;
+        free(cold);
+    }
+    free(idx);
+    return visited;
+}
+
+static void print_my_booking(const Booking *b, void *ctx) {
+    (void)ctx;
+    const EventInfo *info = &event_info[b->event_id];
+    char time_str[26], seat[MAX_SEAT_LABEL];
+    strftime(time_str, 26, "%Y-%m-%d %H:%M", localtime(&b->timestamp));
+    booking_seat_label(b, seat, sizeof(seat));
+    printf("\n Booking ID: %s\n", b->booking_id);
+    printf("  Event: %s - %s @ %s\n", info->name, info->event_date, info->event_time);
+    printf("  Seat: [%s]\n", seat);
+    printf("  Price Paid: Rs.%.2f\n", b->price_paid);
+    printf("  Booked On: %s\n", time_str);
+    printf(" -------------------------------------------------------\n");
+}
+
 void view_my_bookings(const User *user) {
     printf("\n+============================================================+\n");
     printf("|          MY BOOKINGS - %s\n", user->username);
     printf("+============================================================+\n");
-    int found = 0;
-    for (int e = 0; e < event_count; ++e) {
-        Booking *b = events[e].bookings_head;
-        while (b) {
-            if (strcmp(b->username, user->username) == 0) {
-                char time_str[26];
-                struct tm *tm_info = localtime(&b->timestamp);
-                strftime(time_str, 26, "%Y-%m-%d %H:%M", tm_info);
-                
-                printf("\n Booking ID: %s\n", b->booking_id);
-                printf("  Event: %s - %s @ %s\n", events[e].name, events[e].event_date, events[e].event_time);
-                printf("  Seat: [%c%d]\n", 'A' + b->row, b->col + 1);
-                printf("  Price Paid: Rs.%.2f\n", b->price_paid);
-                printf("  Booked On: %s\n", time_str);
-                printf(" -------------------------------------------------------\n");
-                found = 1;
-            }
-            b = b->next;
-        }
-    }
-    if (!found) printf("\n  (no bookings)\n");
+    if (visit_user_bookings(user->username, print_my_booking, NULL) == 0) printf("\n  (no bookings)\n");
+}
+
+typedef struct SearchTerm {
+    int field;   /* menu choice in search_bookings_interactive */
+    const char *term;
+} SearchTerm;
+
+static int booking_matches_search(const Booking *b, const void *arg) {
+    const SearchTerm *s = (const SearchTerm *)arg;
+    const char *value = s->field == 1 ? b->booking_id : s->field == 2 ? b->username : b->phone;
+    return booking_field_matches(s->field, value, s->term);
 }
 
-/* Search bookings by ID, username, or phone */
+static void print_search_result(const Booking *b, int e) {
+    char time_str[26], seat[MAX_SEAT_LABEL];
+    struct tm *tm_info = localtime(&b->timestamp);
+    strftime(time_str, 26, "%Y-%m-%d %H:%M", tm_info);
+    SeatRef sr = { b->section, b->row, b->col };
+    format_seat_label(events[e].layout, sr, seat, sizeof(seat));
+    
+    printf("\n Booking ID: %s\n", b->booking_id);
+    printf("  Customer: %s\n", b->username);
+    printf("  Event: %s - %s @ %s\n", event_info[e].name, event_info[e].event_date, event_info[e].event_time);
+    printf("  Seat: [%s]\n", seat);
+    printf("  Price Paid: Rs.%.2f\n", b->price_paid);
+    printf("  Booked On: %s\n", time_str);
+    printf("  Contact: %s | %s\n", b->phone, b->email);
+    printf(" -------------------------------------------------------\n");
+}
+
+/* Search bookings by ID, username, or phone (exact, prefix or ending) */
 void search_bookings_interactive(void) {
     printf("\nSearch bookings by:\n");
     printf("1) Booking ID\n");
     printf("2) Username\n");
     printf("3) Phone number\n");
+    printf("4) Phone number starting with\n");
+    printf("5) Phone number ending with\n");
     printf("Choose: ");
     int choice = read_int();
     
@@ -639,6 +1043,9 @@ void search_bookings_interactive(void) {
     } else if (choice == 3) {
         printf("Enter Phone: ");
         read_line(search_term, sizeof(search_term));
+    } else if (choice == 4 || choice == 5) {
+        printf("Enter the %s digits: ", choice == 4 ? "first" : "last");
+        read_line(search_term, sizeof(search_term));
     } else {
         printf("Invalid choice.\n");
         return;
@@ -648,57 +1055,76 @@ void search_bookings_interactive(void) {
     printf("|              SEARCH RESULTS                                |\n");
     printf("+============================================================+\n");
     
-    int found = 0;
+    /* Loaded events: index lookups, costing what the matches cost. Events
+     * not loaded yet are read from their snapshot ranges, not materialized. */
+    const BookingColumns *c = &booking_cols;
+    SearchTerm st = { choice, search_term };
+    int hot, j = 0, n = 0, shown = 0;
+    int *idx;
+    if (choice == 1) idx = collect_key_matches(&c->groups, search_term, &hot);
+    else if (choice == 2) idx = collect_key_matches(&c->users, search_term, &hot);
+    else if (choice == 3) idx = collect_key_matches(&c->phones, search_term, &hot);
+    else idx = collect_phone_matches(search_term, choice == 5, &hot);
     for (int e = 0; e < event_count; ++e) {
-        Booking *b = events[e].bookings_head;
-        while (b) {
-            int match = 0;
-            if (choice == 1 && strcmp(b->booking_id, search_term) == 0) match = 1;
-            else if (choice == 2 && strcmp(b->username, search_term) == 0) match = 1;
-            else if (choice == 3 && strcmp(b->phone, search_term) == 0) match = 1;
-            
-            if (match) {
-                char time_str[26];
-                struct tm *tm_info = localtime(&b->timestamp);
-                strftime(time_str, 26, "%Y-%m-%d %H:%M", tm_info);
-                
-                printf("\n Booking ID: %s\n", b->booking_id);
-                printf("  Customer: %s\n", b->username);
-                printf("  Event: %s - %s @ %s\n", events[e].name, events[e].event_date, events[e].event_time);
-                printf("  Seat: [%c%d]\n", 'A' + b->row, b->col + 1);
-                printf("  Price Paid: Rs.%.2f\n", b->price_paid);
-                printf("  Booked On: %s\n", time_str);
-                printf("  Contact: %s | %s\n", b->phone, b->email);
-                printf(" -------------------------------------------------------\n");
-                found = 1;
-            }
-            b = b->next;
+        if (events[e].materialized) {
+            for (; j < hot && c->event[idx[j]] == e; ++j, ++n)
+                if (shown < MAX_SEARCH_RESULTS) { print_search_result(c->ref[idx[j]], e); shown++; }
+            continue;
         }
+        int m;
+        Booking *cold = scan_snapshot_bookings(e, booking_matches_search, &st, &m);
+        for (int k = 0; k < m && shown < MAX_SEARCH_RESULTS; ++k, ++shown) print_search_result(&cold[k], e);
+        n += m;
+        free(cold);
     }
+    free(idx);
+
+    /* Finished events live in the archive and are scanned only here */
+    int cold = archive_search_bookings(choice, search_term, MAX_SEARCH_RESULTS - shown);
+    int cold_shown = cold < MAX_SEARCH_RESULTS - shown ? cold : MAX_SEARCH_RESULTS - shown;
+    n += cold;
+    shown += cold_shown;
+    if (n > shown) printf("\n  ... %d more matching seats not shown; refine the search.\n", n - shown);
     
-    if (!found) {
+    if (n == 0) {
         printf("\n  No bookings found matching '%s'\n", search_term);
     }
 }
 
 /* Cancel booking by ID (admin function) */
-int cancel_booking_by_id(const char *booking_id) {
-    for (int e = 0; e < event_count; ++e) {
+int cancel_booking_by_id(const char *booking_id, const char *request_key) {
+    int res = 0;
+    if (replay_request("cancel-id", request_key, &res)) return res;
+    /* Current IDs name their event; older ones mean searching them all */
+    int first = 0, last = event_count - 1;
+    unsigned int shard, event_no;
+    uint64_t seq;
+    if (booking_id_decode(booking_id, &shard, &seq, &event_no)) {
+        first = last = event_by_number(event_no);
+        if (first < 0) { printf("Booking ID '%s' not found.\n", booking_id); return 0; }
+        event_materialize(first);
+    } else {
+        materialize_all_events();
+    }
+    for (int e = first; e <= last; ++e) {
         Event *ev = &events[e];
-        Booking *prev = NULL, *cur = ev->bookings_head;
-        while (cur) {
+        for (Booking *cur = ev->bookings_head; cur; cur = cur->next) {
             if (strcmp(cur->booking_id, booking_id) == 0) {
-                int r = cur->row, c = cur->col;
                 double refund_amount = calculate_refund(cur->price_paid);
+                char label[MAX_SEAT_LABEL];
+                booking_seat_label(cur, label, sizeof(label));
                 
                 printf("\nCancelling booking %s...\n", booking_id);
                 printf("  Customer: %s\n", cur->username);
-                printf("  Seat: %c%d | Refund: Rs.%.2f\n", 'A' + r, c + 1, refund_amount);
+                printf("  Seat: %s | Refund: Rs.%.2f\n", label, refund_amount);
                 
-                if (prev) prev->next = cur->next; else ev->bookings_head = cur->next;
-                free(cur);
-                ev->seats[seat_index(ev, r, c)] = 0;
-                ev->revenue -= refund_amount;
+                Txn txn;
+                txn_begin(&txn);
+                txn_cancel(&txn, cur, refund_amount);
+                if (!txn_commit(&txn)) {
+                    printf("The cancellation could not be saved, so it is not confirmed.\n");
+                    return 0;
+                }
                 
                 /* Try to assign to waiting queue */
                 char namebuf[MAX_USERNAME], phonebuf[MAX_PHONE], emailbuf[MAX_EMAIL];
@@ -709,36 +1135,346 @@ int cancel_booking_by_id(const char *booking_id) {
                     /* Note: This simplified version just notifies. Full implementation would auto-book. */
                 }
                 
+                char summary[DEDUP_MAX_SUMMARY];
+                snprintf(summary, sizeof(summary), "Cancelled booking %s, seat %s | Refund: Rs.%.2f",
+                         booking_id, label, refund_amount);
+                dedup_remember("cancel-id", request_key, 1, summary);
                 return 1;
             }
-            prev = cur;
-            cur = cur->next;
         }
     }
     printf("Booking ID '%s' not found.\n", booking_id);
     return 0;
 }
 
+/* ============= REQUESTS FROM THE SHARD ROUTER ============= */
+
+int book_seats_direct(int event_idx, const User *user, int num_seats, const char *code,
+                      char *booking_id, TextBuf *labels, double *total, const char **err) {
+    *total = 0.0;
+    if (event_idx < 0 || event_idx >= event_count) { *err = "no such event"; return 0; }
+    if (num_seats < 1 || num_seats > 10) { *err = "book between 1 and 10 seats"; return 0; }
+    event_materialize(event_idx);
+    Event *ev = &events[event_idx];
+    int allowance = purchase_allowance(event_idx, user->username, user->phone);
+    if (num_seats > allowance) { *err = "purchase limit reached for this event"; return 0; }
+    if (get_available_seat_count(event_idx) < num_seats) { *err = "not enough seats available"; return 0; }
+
+    SeatRef seats[10];
+    double prices[10];
+    if (!auto_assign_multiple_seats(event_idx, num_seats, seats)) { *err = "could not assign seats"; return 0; }
+    for (int i = 0; i < num_seats; ++i) {
+        prices[i] = apply_discount_event(event_seat_price(ev, seats[i]), code,
+                                         event_info[event_idx].discount_code, event_info[event_idx].discount_percent);
+        *total += prices[i];
+    }
+
+    Booking tmpl;
+    memset(&tmpl, 0, sizeof(tmpl));
+    snprintf(tmpl.username, sizeof(tmpl.username), "%s", user->username);
+    snprintf(tmpl.display_name, sizeof(tmpl.display_name), "%s", user->username);
+    snprintf(tmpl.phone, sizeof(tmpl.phone), "%s", user->phone);
+    snprintf(tmpl.email, sizeof(tmpl.email), "%s", user->email);
+    new_booking_id(event_idx, tmpl.booking_id);
+    tmpl.event_id = event_idx;
+    tmpl.timestamp = time(NULL);
+    Txn txn;
+    txn_begin(&txn);
+    if (!txn_book(&txn, &tmpl, seats, prices, num_seats)) { *err = "could not reserve the seats"; return 0; }
+    if (!txn_commit(&txn)) { *err = "booking could not be made durable"; return 0; }
+
+    strcpy(booking_id, tmpl.booking_id);
+    for (int i = 0; i < num_seats; ++i) {
+        char label[MAX_SEAT_LABEL];
+        format_seat_label(ev->layout, seats[i], label, sizeof(label));
+        tb_printf(labels, "%s%s", i ? " " : "", label);
+    }
+    return 1;
+}
+
+int cancel_booking_direct(int event_idx, const char *booking_id, const char *username, double *refund) {
+    *refund = 0.0;
+    if (event_idx < 0 || event_idx >= event_count) return 0;
+    event_materialize(event_idx);
+    Txn txn;
+    txn_begin(&txn);
+    for (Booking *b = events[event_idx].bookings_head; b; b = b->next) {
+        if (strcmp(b->booking_id, booking_id) != 0 || strcmp(b->username, username) != 0) continue;
+        double r = calculate_refund(b->price_paid);
+        txn_cancel(&txn, b, r);
+        *refund += r;
+    }
+    int cancelled = txn.count;
+    if (cancelled == 0) { txn_rollback(&txn); return 0; }
+    if (!txn_commit(&txn)) return -1;
+    for (int i = 0; i < cancelled; ++i) promote_waiting(event_idx);
+    return cancelled;
+}
+
+int join_waiting_direct(int event_idx, const User *user, int num_seats) {
+    if (event_idx < 0 || event_idx >= event_count || num_seats < 1 || num_seats > 10) return 0;
+    event_materialize(event_idx);
+    enqueue_waiting(event_idx, user, num_seats);
+    return 1;
+}
+
+/* ============= BOOKINGS SNAPSHOT AND INDEX ============= */
+
+/* bookings.txt holds each event's records contiguously and ends with a
+ * "#snapshot <id>" line. Next to it, <path>.idx names the same id and
+ * gives every event's byte range and summary counters:
+ *   IDX|<id>|<events>
+ *   <offset>|<length>|<seats booked>|<revenue>|<bookings>
+ * With a matching index, startup reads only the index; an event's records
+ * are parsed when it is materialized. The startup file stays open so the
+ * ranges remain readable after later snapshots replace it on disk. */
+static FILE *snapshot_fp = NULL;
+static unsigned long snapshot_seq = 0;
+
+static int parse_booking_fields(char *line, Booking *b);
+static char *read_snapshot_range(int event_idx);
+
+static void index_path_for(const char *path, char *out, size_t n) {
+    snprintf(out, n, "%s.idx", path);
+}
+
+/* Copy an unmaterialized event's records from the startup snapshot,
+ * renumbering them in case events were removed since */
+static void copy_snapshot_records(TextBuf *tb, int event_idx) {
+    char *buf = read_snapshot_range(event_idx);
+    if (!buf) return;
+    for (char *line = buf; *line; ) {
+        char *nl = strchr(line, '\n');
+        size_t len = nl ? (size_t)(nl - line) + 1 : strlen(line);
+        char *bar = memchr(line, '|', len);
+        if (bar) {
+            tb_printf(tb, "%d", event_idx);
+            tb_append(tb, bar, len - (size_t)(bar - line));
+            if (!nl) tb_append(tb, "\n", 1);
+        }
+        line += len;
+    }
+    free(buf);
+}
+
 /* Save all bookings to file */
 void save_bookings_to_file(const char *path) {
-    FILE *fp = fopen(path, "w");
-    if (!fp) {
-        printf("Failed to open %s for writing bookings.\n", path);
-        return;
-    }
+    /* Serialize on this thread; the snapshot writer does the file I/O */
+    TextBuf tb, ix;
+    tb_init(&tb, 64 * 1024);
+    tb_init(&ix, (size_t)event_count * 48 + 64);
+    unsigned long id = ((unsigned long)time(NULL) << 16) | (++snapshot_seq & 0xffff);
+    tb_printf(&ix, "IDX|%lu|%d\n", id, event_count);
     
     for (int e = 0; e < event_count; ++e) {
         Event *ev = &events[e];
+        size_t start = tb.len;
+        double revenue = 0.0;
+        int records = 0;
+        if (!ev->materialized) {
+            if (event_info[e].snap_len > 0) copy_snapshot_records(&tb, e);
+            revenue = ev->revenue;
+            records = ev->total_bookings;
+        }
         Booking *b = ev->bookings_head;
         while (b) {
-            /* Format: event_id|username|display_name|phone|email|row|col|price_paid|booking_id|timestamp|num_seats */
-            fprintf(fp, "%d|%s|%s|%s|%s|%d|%d|%.2f|%s|%ld|%d\n",
-                    b->event_id, b->username, b->display_name, b->phone, b->email,
-                    b->row, b->col, b->price_paid, b->booking_id, (long)b->timestamp, b->num_seats);
+            format_booking_record(&tb, b);
+            revenue += b->price_paid;
+            records++;
             b = b->next;
         }
+        /* The counters a full load would rebuild from these records */
+        tb_printf(&ix, "%lu|%lu|%d|%.2f|%d\n", (unsigned long)start, (unsigned long)(tb.len - start),
+                  ev->occ.booked, revenue, records);
     }
-    fclose(fp);
+    tb_printf(&tb, "#snapshot %lu\n", id);
+    submit_snapshot(path, &tb);
+    char idx_path[512];
+    index_path_for(path, idx_path, sizeof(idx_path));
+    submit_snapshot(idx_path, &ix);
+}
+
+/* Use the index next to path if it describes path and the loaded events.
+ * Fills in every event's summary counters and snapshot range and keeps
+ * path open for materialization. Returns 0 if a full load is needed. */
+int open_bookings_snapshot(const char *path) {
+    char idx_path[512], line[128];
+    index_path_for(path, idx_path, sizeof(idx_path));
+    FILE *ix = fopen(idx_path, "r");
+    if (!ix) return 0;
+    FILE *fp = fopen(path, "rb");
+    if (!fp) { fclose(ix); return 0; }
+
+    /* The trailer of bookings.txt must name the index's snapshot */
+    unsigned long id = 0, trailer_id = 1;
+    int count = -1;
+    long data_end = -1;
+    if (fgets(line, sizeof(line), ix)) sscanf(line, "IDX|%lu|%d", &id, &count);
+    if (fseek(fp, 0, SEEK_END) == 0) {
+        long size = ftell(fp);
+        long from = size > 64 ? size - 64 : 0;
+        char tail[65];
+        if (fseek(fp, from, SEEK_SET) == 0) {
+            size_t got = fread(tail, 1, sizeof(tail) - 1, fp);
+            tail[got] = '\0';
+            char *mark = NULL;
+            for (char *p = strstr(tail, "#snapshot "); p; p = strstr(p + 1, "#snapshot ")) mark = p;
+            if (mark && sscanf(mark, "#snapshot %lu", &trailer_id) == 1) data_end = from + (long)(mark - tail);
+        }
+    }
+    int ok = count >= 0 && count <= event_count && data_end >= 0 && trailer_id == id;
+
+    long *ranges = (long *)malloc(sizeof(long) * 2 * (size_t)(count > 0 ? count : 1));
+    double *revenue = (double *)malloc(sizeof(double) * (size_t)(count > 0 ? count : 1));
+    int *counts = (int *)malloc(sizeof(int) * 2 * (size_t)(count > 0 ? count : 1));
+    if (!ranges || !revenue || !counts) { fprintf(stderr, "Memory allocation failed\n"); exit(1); }
+    for (int e = 0; ok && e < count; ++e) {
+        ok = fgets(line, sizeof(line), ix) &&
+             sscanf(line, "%ld|%ld|%d|%lf|%d", &ranges[2 * e], &ranges[2 * e + 1], &counts[2 * e],
+                    &revenue[e], &counts[2 * e + 1]) == 5 &&
+             ranges[2 * e] >= 0 && ranges[2 * e + 1] >= 0 && ranges[2 * e] + ranges[2 * e + 1] <= data_end;
+    }
+    fclose(ix);
+    if (ok) {
+        /* Events created after the snapshot have no records in it */
+        for (int e = 0; e < event_count; ++e) {
+            Event *ev = &events[e];
+            if (ev->materialized) continue;
+            event_info[e].snap_offset = e < count ? ranges[2 * e] : 0;
+            event_info[e].snap_len = e < count ? ranges[2 * e + 1] : 0;
+            ev->occ.booked = e < count ? counts[2 * e] : 0;
+            ev->revenue = e < count ? revenue[e] : 0.0;
+            ev->total_bookings = e < count ? counts[2 * e + 1] : 0;
+        }
+        snapshot_fp = fp;
+    } else {
+        fclose(fp);
+    }
+    free(ranges);
+    free(revenue);
+    free(counts);
+    return ok;
+}
+
+/* A header-only event's records from the startup snapshot, NUL-terminated;
+ * NULL if it has none */
+static char *read_snapshot_range(int event_idx) {
+    const EventInfo *info = &event_info[event_idx];
+    if (!snapshot_fp || info->snap_len <= 0) return NULL;
+    char *buf = (char *)malloc((size_t)info->snap_len + 1);
+    if (!buf) { fprintf(stderr, "Memory allocation failed\n"); exit(1); }
+    size_t got = 0;
+    if (fseek(snapshot_fp, info->snap_offset, SEEK_SET) == 0) got = fread(buf, 1, (size_t)info->snap_len, snapshot_fp);
+    buf[got] = '\0';
+    return buf;
+}
+
+/* Parse a header-only event's records from the startup snapshot, in file
+ * order as load_bookings_from_file() would */
+void load_snapshot_bookings(int event_idx) {
+    Event *ev = &events[event_idx];
+    char *buf = read_snapshot_range(event_idx);
+    if (!buf) return;
+    char *save = NULL;
+    for (char *line = strtok_r(buf, "\n", &save); line; line = strtok_r(NULL, "\n", &save)) {
+        Booking *b = (Booking *)malloc(sizeof(Booking));
+        if (!b) { fprintf(stderr, "Memory allocation failed\n"); exit(1); }
+        SeatRef seat;
+        if (!parse_booking_fields(line, b)) { free(b); continue; }
+        b->event_id = event_idx;
+        seat.section = b->section; seat.row = b->row; seat.col = b->col;
+        if (!venue_seat_valid(ev->layout, seat)) { free(b); continue; }
+        b->next = ev->bookings_head;
+        ev->bookings_head = b;
+        apply_loaded_booking(b);
+        columns_add(b);
+    }
+    free(buf);
+}
+
+/* Lookups that must not materialize an event: parse its records into a
+ * scratch array and keep those match() accepts, newest first. Returns a
+ * malloc'd array (NULL if none). */
+static Booking *scan_snapshot_bookings(int event_idx, int (*match)(const Booking *, const void *),
+                                       const void *arg, int *count) {
+    *count = 0;
+    char *buf = read_snapshot_range(event_idx);
+    if (!buf) return NULL;
+    Booking *found = NULL;
+    int cap = 0;
+    char *save = NULL;
+    for (char *line = strtok_r(buf, "\n", &save); line; line = strtok_r(NULL, "\n", &save)) {
+        Booking b;
+        if (!parse_booking_fields(line, &b)) continue;
+        b.event_id = event_idx;
+        SeatRef seat = { b.section, b.row, b.col };
+        if (!venue_seat_valid(events[event_idx].layout, seat) || !match(&b, arg)) continue;
+        if (*count == cap) {
+            cap = cap ? cap * 2 : 8;
+            Booking *tmp = (Booking *)realloc(found, sizeof(Booking) * (size_t)cap);
+            if (!tmp) { fprintf(stderr, "Memory allocation failed\n"); exit(1); }
+            found = tmp;
+        }
+        found[(*count)++] = b;
+    }
+    free(buf);
+    /* The file holds an event's records oldest first */
+    for (int i = 0, j = *count - 1; i < j; ++i, --j) {
+        Booking t = found[i];
+        found[i] = found[j];
+        found[j] = t;
+    }
+    return found;
+}
+
+void close_bookings_snapshot(void) {
+    if (snapshot_fp) fclose(snapshot_fp);
+    snapshot_fp = NULL;
+}
+
+/* Fields of one bookings.txt record, unchecked against the events */
+static int parse_booking_fields(char *line, Booking *b) {
+    char *save = NULL;
+    char *tok;
+    tok = strtok_r(line, "|", &save); if (!tok) return 0; b->event_id = atoi(tok);
+    tok = strtok_r(NULL, "|", &save); if (!tok) return 0; strncpy(b->username, tok, MAX_USERNAME-1); b->username[MAX_USERNAME-1] = '\0';
+    tok = strtok_r(NULL, "|", &save); if (!tok) return 0; strncpy(b->display_name, tok, MAX_NAME-1); b->display_name[MAX_NAME-1] = '\0';
+    tok = strtok_r(NULL, "|", &save); if (!tok) return 0; strncpy(b->phone, tok, MAX_PHONE-1); b->phone[MAX_PHONE-1] = '\0';
+    tok = strtok_r(NULL, "|", &save); if (!tok) return 0; strncpy(b->email, tok, MAX_EMAIL-1); b->email[MAX_EMAIL-1] = '\0';
+    tok = strtok_r(NULL, "|", &save); if (!tok) return 0; b->row = atoi(tok);
+    tok = strtok_r(NULL, "|", &save); if (!tok) return 0; b->col = atoi(tok);
+    tok = strtok_r(NULL, "|", &save); if (!tok) return 0; b->price_paid = atof(tok);
+    tok = strtok_r(NULL, "|", &save); if (!tok) return 0; strncpy(b->booking_id, tok, 31); b->booking_id[31] = '\0';
+    tok = strtok_r(NULL, "|", &save); if (!tok) return 0; b->timestamp = (time_t)atol(tok);
+    tok = strtok_r(NULL, "|", &save); if (!tok) return 0; b->num_seats = atoi(tok);
+    tok = strtok_r(NULL, "|", &save); b->section = tok ? atoi(tok) : 0;  /* absent in pre-section files */
+    b->col_slot = -1;
+    return 1;
+}
+
+/* Parse one bookings.txt record into *b (b->next is left untouched).
+ * Format: event_id|username|display_name|phone|email|row|col|price_paid|booking_id|timestamp|num_seats[|section]
+ * The line buffer is tokenized in place. Returns 1 if the record is valid
+ * for the currently loaded events, 0 otherwise. Safe to call from worker threads. */
+int parse_booking_record(char *line, Booking *b) {
+    if (!parse_booking_fields(line, b)) return 0;
+
+    /* Validate against loaded events */
+    if (b->event_id < 0 || b->event_id >= event_count) return 0;
+    SeatRef seat = { b->section, b->row, b->col };
+    return venue_seat_valid(events[b->event_id].layout, seat);
+}
+
+/* Apply a loaded booking's effect on its event's seat map, stats and
+ * purchase counts.
+ * Does not link the node; callers building lists in bulk link them first. */
+void apply_loaded_booking(const Booking *b) {
+    Event *ev = &events[b->event_id];
+    SeatRef seat = { b->section, b->row, b->col };
+    event_mark_seat(ev, seat);
+    ev->revenue += b->price_paid;
+    ev->total_bookings++;
+    purchase_count(b->event_id, b->username, b->phone, 1);
 }
 
 /* Load all bookings from file */
@@ -748,55 +1484,134 @@ void load_bookings_from_file(const char *path) {
     
     char line[512];
     while (fgets(line, sizeof(line), fp)) {
-        /* Parse: event_id|username|display_name|phone|email|row|col|price_paid|booking_id|timestamp|num_seats */
-        int event_id, row, col, num_seats;
-        double price_paid;
-        long timestamp;
-        char username[MAX_USERNAME], display_name[MAX_NAME], phone[MAX_PHONE], email[MAX_EMAIL], booking_id[32];
-        
-        char *tok;
-        tok = strtok(line, "|"); if (!tok) continue; event_id = atoi(tok);
-        tok = strtok(NULL, "|"); if (!tok) continue; strncpy(username, tok, MAX_USERNAME-1); username[MAX_USERNAME-1] = '\0';
-        tok = strtok(NULL, "|"); if (!tok) continue; strncpy(display_name, tok, MAX_NAME-1); display_name[MAX_NAME-1] = '\0';
-        tok = strtok(NULL, "|"); if (!tok) continue; strncpy(phone, tok, MAX_PHONE-1); phone[MAX_PHONE-1] = '\0';
-        tok = strtok(NULL, "|"); if (!tok) continue; strncpy(email, tok, MAX_EMAIL-1); email[MAX_EMAIL-1] = '\0';
-        tok = strtok(NULL, "|"); if (!tok) continue; row = atoi(tok);
-        tok = strtok(NULL, "|"); if (!tok) continue; col = atoi(tok);
-        tok = strtok(NULL, "|"); if (!tok) continue; price_paid = atof(tok);
-        tok = strtok(NULL, "|"); if (!tok) continue; strncpy(booking_id, tok, 31); booking_id[31] = '\0';
-        tok = strtok(NULL, "|"); if (!tok) continue; timestamp = atol(tok);
-        tok = strtok(NULL, "|"); if (!tok) continue; num_seats = atoi(tok);
-        
-        /* Validate event_id */
-        if (event_id < 0 || event_id >= event_count) continue;
-        
-        Event *ev = &events[event_id];
-        
-        /* Create booking and add to event */
         Booking *b = (Booking *)malloc(sizeof(Booking));
         if (!b) continue;
+        if (!parse_booking_record(line, b)) { free(b); continue; }
         
-        strncpy(b->username, username, MAX_USERNAME-1); b->username[MAX_USERNAME-1] = '\0';
-        strncpy(b->display_name, display_name, MAX_NAME-1); b->display_name[MAX_NAME-1] = '\0';
-        strncpy(b->phone, phone, MAX_PHONE-1); b->phone[MAX_PHONE-1] = '\0';
-        strncpy(b->email, email, MAX_EMAIL-1); b->email[MAX_EMAIL-1] = '\0';
-        strncpy(b->booking_id, booking_id, 31); b->booking_id[31] = '\0';
-        b->event_id = event_id;
-        b->row = row;
-        b->col = col;
-        b->price_paid = price_paid;
-        b->timestamp = (time_t)timestamp;
-        b->num_seats = num_seats;
+        /* Add to event and mark seat as booked */
+        Event *ev = &events[b->event_id];
         b->next = ev->bookings_head;
         ev->bookings_head = b;
-        
-        /* Mark seat as booked */
-        ev->seats[seat_index(ev, row, col)] = 1;
-        
-        /* Update event stats */
-        ev->revenue += price_paid;
-        ev->total_bookings++;
+        apply_loaded_booking(b);
     }
     
     fclose(fp);
-}
\ No newline at end of file
+}
+
+/* Apply one journal record on top of the loaded snapshot. Records the
+ * snapshot already reflects (crash between snapshot and journal reset)
+ * are skipped: an add for a taken seat or a remove for a missing booking. */
+static void apply_journal_record(char *line, int *applied) {
+    if (line[0] == 'A' && line[1] == '|') {
+        Booking *b = (Booking *)malloc(sizeof(Booking));
+        if (!b) return;
+        if (!parse_booking_record(line + 2, b)) { free(b); return; }
+        event_materialize(b->event_id);
+        Event *ev = &events[b->event_id];
+        SeatRef seat = { b->section, b->row, b->col };
+        if (event_seat_taken(ev, seat)) { free(b); return; }
+        b->next = ev->bookings_head;
+        ev->bookings_head = b;
+        apply_loaded_booking(b);
+        (*applied)++;
+    } else if (line[0] == 'X' && line[1] == '|') {
+        char *save = NULL;
+        char *tok;
+        int event_id, row, col;
+        tok = strtok_r(line + 2, "|", &save); if (!tok) return; event_id = atoi(tok);
+        tok = strtok_r(NULL, "|", &save); if (!tok) return; row = atoi(tok);
+        tok = strtok_r(NULL, "|", &save); if (!tok) return; col = atoi(tok);
+        tok = strtok_r(NULL, "|", &save); if (!tok) return;
+        char *booking_id = tok;
+        tok = strtok_r(NULL, "|", &save);
+        int section = tok ? atoi(tok) : 0;
+        if (event_id < 0 || event_id >= event_count) return;
+        event_materialize(event_id);
+        Event *ev = &events[event_id];
+        Booking *prev = NULL, *cur = ev->bookings_head;
+        while (cur) {
+            if (cur->section == section && cur->row == row && cur->col == col && strcmp(cur->booking_id, booking_id) == 0) {
+                /* Undo exactly what apply_loaded_booking() did */
+                SeatRef seat = { section, row, col };
+                if (prev) prev->next = cur->next; else ev->bookings_head = cur->next;
+                event_release_seat(ev, seat);
+                ev->revenue -= cur->price_paid;
+                ev->total_bookings--;
+                purchase_count(event_id, cur->username, cur->phone, -1);
+                columns_remove(cur);
+                free(cur);
+                (*applied)++;
+                return;
+            }
+            prev = cur;
+            cur = cur->next;
+        }
+    }
+}
+
+/* The records of a "T|<count>" transaction are held back until all of
+ * them have been read; one cut short by a crash is dropped whole */
+typedef struct JournalReplay {
+    int applied;
+    char **txn_lines;
+    int txn_have;
+    int txn_want;   /* 0 = not inside a transaction */
+} JournalReplay;
+
+static void drop_transaction(JournalReplay *r) {
+    for (int i = 0; i < r->txn_have; ++i) free(r->txn_lines[i]);
+    free(r->txn_lines);
+    r->txn_lines = NULL;
+    r->txn_have = r->txn_want = 0;
+}
+
+static void replay_booking_record(char *line, void *ctx) {
+    JournalReplay *r = (JournalReplay *)ctx;
+    int is_change = (line[0] == 'A' || line[0] == 'X') && line[1] == '|';
+    if (r->txn_want && !is_change) {
+        printf("Warning: dropped an incomplete transaction from the journal.\n");
+        drop_transaction(r);
+    }
+    if (line[0] == 'T' && line[1] == '|') {
+        int want = atoi(line + 2);
+        if (want < 1) return;
+        r->txn_lines = (char **)malloc(sizeof(char *) * (size_t)want);
+        if (!r->txn_lines) { fprintf(stderr, "Memory allocation failed\n"); exit(1); }
+        r->txn_want = want;
+        return;
+    }
+    if (!r->txn_want) { apply_journal_record(line, &r->applied); return; }
+    r->txn_lines[r->txn_have] = strdup(line);
+    if (!r->txn_lines[r->txn_have]) { fprintf(stderr, "Memory allocation failed\n"); exit(1); }
+    if (++r->txn_have < r->txn_want) return;
+    for (int i = 0; i < r->txn_have; ++i) apply_journal_record(r->txn_lines[i], &r->applied);
+    drop_transaction(r);
+}
+
+int replay_bookings_journal(const char *path) {
+    JournalReplay r = { 0, NULL, 0, 0 };
+    journal_replay(path, replay_booking_record, &r);
+    if (r.txn_want) {
+        printf("Warning: dropped an incomplete transaction from the journal.\n");
+        drop_transaction(&r);
+    }
+    return r.applied;
+}
+
+/* Write a full bookings snapshot and, once it is durable, empty the journal */
+void checkpoint_bookings(const char *path) {
+    save_bookings_to_file(path);
+    if (wait_for_snapshots()) journal_reset();
+}
+
+/* After a booking change in bookings.txt/events.txt in the current
+ * directory: the journal already made it durable, so only checkpoint once
+ * the journal grows large; without a journal, save full snapshots. */
+void persist_booking_change(void) {
+    if (!journal_is_open()) {
+        save_bookings_to_file("bookings.txt");
+        save_events_to_file("events.txt");
+        return;
+    }
+    if (journal_size() > JOURNAL_CHECKPOINT_BYTES) checkpoint_bookings("bookings.txt");
+}
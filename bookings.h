@@ -11,12 +11,14 @@ typedef struct Booking {
     char phone[MAX_PHONE];
     char email[MAX_EMAIL];
     int event_id; /* index into events array */
+    int section;  /* venue section; row/col are within it */
     int row;
     int col;
     double price_paid;
     char booking_id[32];  /* unique booking ID */
     time_t timestamp;     /* when booking was made */
     int num_seats;        /* number of seats in this booking group */
+    int col_slot;         /* entry in booking_cols, -1 if none */
     struct Booking *next;
 } Booking;
 
@@ -43,26 +45,52 @@ int pq_extract_min(PriorityQueue *pq, char *out_username, char *out_phone, char
 void free_priority_queue(PriorityQueue *pq);
 int pq_is_empty(PriorityQueue *pq);
 
-/* Booking ID generation */
-void generate_booking_id(char *out_id, int event_idx, int booking_num);
+void booking_seat_label(const Booking *b, char *out, size_t n);
 
 /* Booking operations */
 void show_all_bookings_for_event(int event_idx);
 void show_all_bookings_admin(void);
 void show_waiting_queue(int event_idx);
-int auto_assign_seat(int event_idx, int *out_row, int *out_col);
-int auto_assign_multiple_seats(int event_idx, int num_seats, int rows_out[], int cols_out[]);
+int auto_assign_seat(int event_idx, SeatRef *out);
+int auto_assign_multiple_seats(int event_idx, int num_seats, SeatRef seats_out[]);
 int book_seat_for_user(int event_idx, User *user);
 int book_multiple_seats_for_user(int event_idx, User *user, int num_seats);
 int cancel_seat_by_user(int event_idx, const User *user);
-int cancel_booking_by_id(const char *booking_id);
+int swap_seat_by_user(int event_idx, const User *user);
+int book_two_events_for_user(int first, int second, User *user);
+int cancel_booking_by_id(const char *booking_id, const char *request_key);
+
+/* Non-interactive forms for the shard servers (see shard.h). Booking takes
+ * the best available seats; it returns 1 with the ID, space-separated seat
+ * labels and total filled in, or 0 with a reason in *err. Cancelling
+ * removes every seat of the booking that belongs to username and returns
+ * how many there were, or -1 if the change could not be journaled. */
+int book_seats_direct(int event_idx, const User *user, int num_seats, const char *code,
+                      char *booking_id, TextBuf *labels, double *total, const char **err);
+int cancel_booking_direct(int event_idx, const char *booking_id, const char *username, double *refund);
+/* Queue user for num_seats; cancellations book them in queue order */
+int join_waiting_direct(int event_idx, const User *user, int num_seats);
 void view_my_bookings(const User *user);
+/* Call visit for each of username's bookings, by event then newest first,
+ * without materializing events; returns how many there were */
+int visit_user_bookings(const char *username, void (*visit)(const Booking *b, void *ctx), void *ctx);
 void show_full_seatmap_all_events(void);
 double calculate_refund(double price_paid);
 void search_bookings_interactive(void);
 
 /* Booking persistence */
 void save_bookings_to_file(const char *path);
+void format_booking_record(TextBuf *tb, const Booking *b);
 void load_bookings_from_file(const char *path);
+int parse_booking_record(char *line, Booking *b);
+void apply_loaded_booking(const Booking *b);
+int replay_bookings_journal(const char *path);
+void checkpoint_bookings(const char *path);
+void persist_booking_change(void);
+
+/* Lazy startup from bookings.txt and its index (see bookings.c) */
+int open_bookings_snapshot(const char *path);
+void load_snapshot_bookings(int event_idx);
+void close_bookings_snapshot(void);
 
 #endif /* BOOKINGS_H */
\ No newline at end of file
@@ -0,0 +1,317 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "columns.h"
+#include "events.h"
+
+BookingColumns booking_cols;
+
+/* ============= STRING DICTIONARY ============= */
+
+static unsigned int hash_str(const char *s) {
+    unsigned int h = 2166136261u;
+    while (*s) { h ^= (unsigned char)*s++; h *= 16777619u; }
+    return h;
+}
+
+static void dict_clear(StrDict *d) {
+    for (int i = 0; i < d->count; ++i) {
+        free(d->names[i]);
+        free(d->postings[i].slots);
+    }
+    free(d->names);
+    free(d->postings);
+    free(d->slots);
+    memset(d, 0, sizeof(*d));
+}
+
+static void dict_grow(StrDict *d) {
+    int n = d->slot_count ? d->slot_count * 2 : 256;
+    int *slots = (int *)malloc(sizeof(int) * (size_t)n);
+    if (!slots) { fprintf(stderr, "Memory allocation failed\n"); exit(1); }
+    for (int i = 0; i < n; ++i) slots[i] = -1;
+    for (int id = 0; id < d->count; ++id) {
+        unsigned int h = hash_str(d->names[id]) & (unsigned int)(n - 1);
+        while (slots[h] >= 0) h = (h + 1) & (unsigned int)(n - 1);
+        slots[h] = id;
+    }
+    free(d->slots);
+    d->slots = slots;
+    d->slot_count = n;
+}
+
+int dict_find(const StrDict *d, const char *s) {
+    if (d->slot_count == 0) return -1;
+    unsigned int mask = (unsigned int)(d->slot_count - 1);
+    for (unsigned int h = hash_str(s) & mask; d->slots[h] >= 0; h = (h + 1) & mask) {
+        if (strcmp(d->names[d->slots[h]], s) == 0) return d->slots[h];
+    }
+    return -1;
+}
+
+static int dict_intern(StrDict *d, const char *s) {
+    int id = dict_find(d, s);
+    if (id >= 0) return id;
+    if ((d->count + 1) * 2 > d->slot_count) dict_grow(d);
+    if (d->count == d->capacity) {
+        int cap = d->capacity ? d->capacity * 2 : 256;
+        char **names = (char **)realloc(d->names, sizeof(char *) * (size_t)cap);
+        if (!names) { fprintf(stderr, "Memory allocation failed\n"); exit(1); }
+        d->names = names;
+        SlotList *postings = (SlotList *)realloc(d->postings, sizeof(SlotList) * (size_t)cap);
+        if (!postings) { fprintf(stderr, "Memory allocation failed\n"); exit(1); }
+        d->postings = postings;
+        d->capacity = cap;
+    }
+    size_t len = strlen(s) + 1;
+    d->names[d->count] = (char *)malloc(len);
+    if (!d->names[d->count]) { fprintf(stderr, "Memory allocation failed\n"); exit(1); }
+    memcpy(d->names[d->count], s, len);
+    d->postings[d->count].slots = NULL;
+    d->postings[d->count].count = d->postings[d->count].cap = 0;
+    unsigned int mask = (unsigned int)(d->slot_count - 1);
+    unsigned int h = hash_str(s) & mask;
+    while (d->slots[h] >= 0) h = (h + 1) & mask;
+    d->slots[h] = d->count;
+    return d->count++;
+}
+
+const SlotList *columns_lookup(const StrDict *d, const char *s) {
+    int id = dict_find(d, s);
+    return id >= 0 ? &d->postings[id] : NULL;
+}
+
+static void slot_list_add(SlotList *l, int slot) {
+    if (l->count == l->cap) {
+        int cap = l->cap ? l->cap * 2 : 4;
+        int *p = (int *)realloc(l->slots, sizeof(int) * (size_t)cap);
+        if (!p) { fprintf(stderr, "Memory allocation failed\n"); exit(1); }
+        l->slots = p;
+        l->cap = cap;
+    }
+    l->slots[l->count++] = slot;
+}
+
+/* ============= COLUMNS ============= */
+
+#define GROW_COLUMN(col, type) do { \
+        type *p_ = (type *)realloc(c->col, sizeof(type) * (size_t)cap); \
+        if (!p_) { fprintf(stderr, "Memory allocation failed\n"); exit(1); } \
+        c->col = p_; \
+    } while (0)
+
+static void ensure_capacity(BookingColumns *c, int needed) {
+    if (needed <= c->capacity) return;
+    int cap = c->capacity ? c->capacity : 1024;
+    while (cap < needed) cap *= 2;
+    GROW_COLUMN(event, int);
+    GROW_COLUMN(user, int);
+    GROW_COLUMN(phone, int);
+    GROW_COLUMN(group, int);
+    GROW_COLUMN(section, short);
+    GROW_COLUMN(row, short);
+    GROW_COLUMN(col, short);
+    GROW_COLUMN(price, double);
+    GROW_COLUMN(timestamp, int64_t);
+    GROW_COLUMN(live, unsigned char);
+    GROW_COLUMN(ref, Booking *);
+    c->capacity = cap;
+}
+
+static void append(BookingColumns *c, int event_idx, Booking *b) {
+    ensure_capacity(c, c->count + 1);
+    int i = c->count++;
+    c->event[i] = event_idx;
+    c->user[i] = dict_intern(&c->users, b->username);
+    c->phone[i] = dict_intern(&c->phones, b->phone);
+    c->group[i] = dict_intern(&c->groups, b->booking_id);
+    c->section[i] = (short)b->section;
+    c->row[i] = (short)b->row;
+    c->col[i] = (short)b->col;
+    c->price[i] = b->price_paid;
+    c->timestamp[i] = (int64_t)b->timestamp;
+    c->live[i] = 1;
+    c->ref[i] = b;
+    b->col_slot = i;
+    slot_list_add(&c->users.postings[c->user[i]], i);
+    slot_list_add(&c->phones.postings[c->phone[i]], i);
+    slot_list_add(&c->groups.postings[c->group[i]], i);
+}
+
+/* Rebuild from the per-event lists: after loading, after deleting an event
+ * (indices shift) and to compact away cancelled entries. Lists are newest
+ * first, so each one is appended back to front. */
+void columns_rebuild(void) {
+    BookingColumns *c = &booking_cols;
+    c->count = 0;
+    c->dead = 0;
+    c->generation++;
+    dict_clear(&c->users);
+    dict_clear(&c->phones);
+    dict_clear(&c->groups);
+    c->phones_sorted = 0;
+    Booking **stack = NULL;
+    int stack_cap = 0;
+    for (int e = 0; e < event_count; ++e) {
+        int n = 0;
+        for (Booking *b = events[e].bookings_head; b; b = b->next) {
+            if (n == stack_cap) {
+                stack_cap = stack_cap ? stack_cap * 2 : 1024;
+                Booking **p = (Booking **)realloc(stack, sizeof(Booking *) * (size_t)stack_cap);
+                if (!p) { fprintf(stderr, "Memory allocation failed\n"); exit(1); }
+                stack = p;
+            }
+            stack[n++] = b;
+        }
+        ensure_capacity(c, c->count + n);
+        while (n > 0) append(c, e, stack[--n]);
+    }
+    free(stack);
+}
+
+void columns_add(Booking *b) {
+    append(&booking_cols, b->event_id, b);
+}
+
+void columns_remove(Booking *b) {
+    BookingColumns *c = &booking_cols;
+    if (b->col_slot < 0 || b->col_slot >= c->count || c->ref[b->col_slot] != b) return;
+    c->live[b->col_slot] = 0;
+    c->ref[b->col_slot] = NULL;
+    b->col_slot = -1;
+    if (++c->dead > 1024 && c->dead > c->count / 2) columns_rebuild();
+}
+
+void columns_free(void) {
+    BookingColumns *c = &booking_cols;
+    free(c->event); free(c->user); free(c->phone); free(c->group);
+    free(c->section); free(c->row); free(c->col);
+    free(c->price); free(c->timestamp); free(c->live); free(c->ref);
+    free(c->phones_by_prefix); free(c->phones_by_suffix);
+    dict_clear(&c->users);
+    dict_clear(&c->phones);
+    dict_clear(&c->groups);
+    memset(c, 0, sizeof(*c));
+}
+
+/* ============= PHONE NUMBER SEARCH ============= */
+
+static int cmp_phone_prefix(const void *a, const void *b) {
+    return strcmp(booking_cols.phones.names[*(const int *)a], booking_cols.phones.names[*(const int *)b]);
+}
+
+/* Compare strings last character first */
+static int cmp_reversed(const char *x, const char *y) {
+    size_t i = strlen(x), j = strlen(y);
+    while (i > 0 && j > 0) {
+        unsigned char cx = (unsigned char)x[--i], cy = (unsigned char)y[--j];
+        if (cx != cy) return cx < cy ? -1 : 1;
+    }
+    return (i > 0) - (j > 0);
+}
+
+static int cmp_phone_suffix(const void *a, const void *b) {
+    return cmp_reversed(booking_cols.phones.names[*(const int *)a], booking_cols.phones.names[*(const int *)b]);
+}
+
+/* Sort the ids added since the last search and merge them into the array */
+static void merge_new_phones(int *sorted, int old_n, int total, int (*cmp)(const void *, const void *)) {
+    int added = total - old_n;
+    int *tail = (int *)malloc(sizeof(int) * (size_t)added);
+    if (!tail) { fprintf(stderr, "Memory allocation failed\n"); exit(1); }
+    for (int k = 0; k < added; ++k) tail[k] = old_n + k;
+    qsort(tail, (size_t)added, sizeof(int), cmp);
+    int i = old_n - 1, j = added - 1, out = total - 1;
+    while (j >= 0) {
+        if (i >= 0 && cmp(&sorted[i], &tail[j]) > 0) sorted[out--] = sorted[i--];
+        else sorted[out--] = tail[j--];
+    }
+    free(tail);
+}
+
+static void update_phone_arrays(BookingColumns *c) {
+    int n = c->phones.count;
+    if (c->phones_sorted == n) return;
+    int *p = (int *)realloc(c->phones_by_prefix, sizeof(int) * (size_t)n);
+    int *q = p ? (int *)realloc(c->phones_by_suffix, sizeof(int) * (size_t)n) : NULL;
+    if (!p || !q) { fprintf(stderr, "Memory allocation failed\n"); exit(1); }
+    c->phones_by_prefix = p;
+    c->phones_by_suffix = q;
+    merge_new_phones(p, c->phones_sorted, n, cmp_phone_prefix);
+    merge_new_phones(q, c->phones_sorted, n, cmp_phone_suffix);
+    c->phones_sorted = n;
+}
+
+static int has_prefix(const char *s, const char *part, size_t n) { return strncmp(s, part, n) == 0; }
+
+static int has_suffix(const char *s, const char *part, size_t n) {
+    size_t len = strlen(s);
+    return len >= n && memcmp(s + len - n, part, n) == 0;
+}
+
+int columns_match_phones(const char *part, int suffix, const int **ids) {
+    BookingColumns *c = &booking_cols;
+    size_t n = strlen(part);
+    *ids = NULL;
+    if (n == 0 || c->phones.count == 0) return 0;
+    update_phone_arrays(c);
+    const int *arr = suffix ? c->phones_by_suffix : c->phones_by_prefix;
+    /* First phone not ordered before part; matches follow contiguously */
+    int lo = 0, hi = c->phones.count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        const char *name = c->phones.names[arr[mid]];
+        int before = suffix ? cmp_reversed(name, part) < 0 : strcmp(name, part) < 0;
+        if (before) lo = mid + 1; else hi = mid;
+    }
+    int end = lo;
+    while (end < c->phones.count &&
+           (suffix ? has_suffix(c->phones.names[arr[end]], part, n)
+                   : has_prefix(c->phones.names[arr[end]], part, n))) end++;
+    *ids = arr + lo;
+    return end - lo;
+}
+
+/* ============= AGGREGATIONS ============= */
+
+/* Recent sales and top customers by spend, one pass over the columns */
+void show_booking_trends(void) {
+    const BookingColumns *c = &booking_cols;
+    if (c->count - c->dead == 0) return;
+    int64_t now = (int64_t)time(NULL);
+    int64_t day_ago = now - 24 * 3600, week_ago = now - 7 * 24 * 3600;
+    int seats_day = 0, seats_week = 0;
+    double rev_day = 0.0, rev_week = 0.0;
+    for (int i = 0; i < c->count; ++i) {
+        int in_day = c->live[i] & (c->timestamp[i] >= day_ago);
+        int in_week = c->live[i] & (c->timestamp[i] >= week_ago);
+        seats_day += in_day;
+        seats_week += in_week;
+        rev_day += in_day ? c->price[i] : 0.0;
+        rev_week += in_week ? c->price[i] : 0.0;
+    }
+
+    double *spend = (double *)calloc((size_t)c->users.count + 1, sizeof(double));
+    if (!spend) return;
+    for (int i = 0; i < c->count; ++i) spend[c->user[i]] += c->live[i] ? c->price[i] : 0.0;
+    int top[5];
+    int top_n = 0;
+    for (int u = 0; u < c->users.count; ++u) {
+        if (spend[u] <= 0.0) continue;
+        int pos = top_n < 5 ? top_n++ : 5;
+        while (pos > 0 && spend[top[pos - 1]] < spend[u]) {
+            if (pos < 5) top[pos] = top[pos - 1];
+            pos--;
+        }
+        if (pos < 5) top[pos] = u;
+    }
+
+    printf("Seats sold in last 24 hours: %d (Rs.%.2f)\n", seats_day, rev_day);
+    printf("Seats sold in last 7 days: %d (Rs.%.2f)\n", seats_week, rev_week);
+    if (top_n > 0) {
+        printf("Top customers by spend:\n");
+        for (int i = 0; i < top_n; ++i) printf("  %d. %s - Rs.%.2f\n", i + 1, c->users.names[top[i]], spend[top[i]]);
+    }
+    free(spend);
+}
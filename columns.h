@@ -0,0 +1,71 @@
+#ifndef COLUMNS_H
+#define COLUMNS_H
+
+#include <stdint.h>
+#include "bookings.h"
+
+/* Column entries for one dictionary key; cancelled entries stay until
+ * the next rebuild and are skipped by readers via the live column */
+typedef struct SlotList {
+    int *slots;
+    int count;
+    int cap;
+} SlotList;
+
+/* String dictionary: maps usernames, phones and booking IDs to dense ids
+ * so the columns hold ints instead of strings. Each id also keeps the
+ * list of its column entries, which makes the dictionary a search index. */
+typedef struct StrDict {
+    char **names;   /* id -> string */
+    SlotList *postings; /* id -> column entries */
+    int count;
+    int capacity;
+    int *slots;     /* open addressing, -1 = empty */
+    int slot_count; /* power of two */
+} StrDict;
+
+/* Columnar copy of every booking, one entry per booked seat. Entries are in
+ * booking order per event after a rebuild; new bookings are appended and
+ * cancelled ones are marked dead until the next compaction. */
+typedef struct BookingColumns {
+    int count;
+    int capacity;
+    int dead;
+    unsigned generation; /* bumped when entries move (rebuild), invalidating cursors */
+    int *event;          /* index into events */
+    int *user;           /* id in users dict */
+    int *phone;          /* id in phones dict */
+    int *group;          /* id in groups dict (the booking ID) */
+    short *section;
+    short *row;
+    short *col;
+    double *price;
+    int64_t *timestamp;
+    unsigned char *live; /* 0 once cancelled */
+    Booking **ref;       /* source node, for fields not kept in columns */
+    StrDict users;
+    StrDict phones;
+    StrDict groups;
+    int *phones_by_prefix;  /* phone ids sorted by number */
+    int *phones_by_suffix;  /* phone ids sorted by reversed number */
+    int phones_sorted;      /* ids below this are in both arrays */
+} BookingColumns;
+
+extern BookingColumns booking_cols;
+
+void columns_rebuild(void);
+void columns_add(Booking *b);
+void columns_remove(Booking *b);
+void columns_free(void);
+
+int dict_find(const StrDict *d, const char *s);
+const SlotList *columns_lookup(const StrDict *d, const char *s);
+
+/* Phone ids whose number starts (or, with suffix, ends) with part: a
+ * contiguous run of a sorted array. Returns the count, *ids its start. */
+int columns_match_phones(const char *part, int suffix, const int **ids);
+
+/* Aggregations over the columns for the analytics report */
+void show_booking_trends(void);
+
+#endif /* COLUMNS_H */
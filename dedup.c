@@ -0,0 +1,93 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "dedup.h"
+#include "users.h"
+#include "utils.h"
+
+/* Entries sit in a ring in insertion order, which with a fixed TTL is also
+ * expiry order, so expiring and evicting both take from the head. A
+ * chained hash over the ring finds a key in O(1). */
+typedef struct DedupEntry {
+    uint64_t hash;
+    char scope[MAX_USERNAME + 8];
+    char key[DEDUP_MAX_KEY];
+    double expires_ms;
+    int next;                        /* next entry in the bucket, -1 = end */
+    DedupResult result;
+} DedupEntry;
+
+static DedupEntry entries[DEDUP_CAPACITY];
+static int buckets[DEDUP_CAPACITY];  /* first entry per bucket, -1 = none */
+static int head = 0;                 /* oldest entry */
+static int count = 0;
+static int initialized = 0;
+
+static uint64_t hash_request(const char *scope, const char *key) {
+    uint64_t h = 1469598103934665603ULL;
+    for (const char *p = scope; *p; ++p) { h ^= (unsigned char)*p; h *= 1099511628211ULL; }
+    h ^= 0xff;
+    h *= 1099511628211ULL;
+    for (const char *p = key; *p; ++p) { h ^= (unsigned char)*p; h *= 1099511628211ULL; }
+    return h;
+}
+
+static int bucket_of(uint64_t h) {
+    return (int)(h % DEDUP_CAPACITY);
+}
+
+static void ensure_init(void) {
+    if (initialized) return;
+    for (int i = 0; i < DEDUP_CAPACITY; ++i) buckets[i] = -1;
+    initialized = 1;
+}
+
+static void drop_oldest(void) {
+    int i = head;
+    int *link = &buckets[bucket_of(entries[i].hash)];
+    while (*link != i) link = &entries[*link].next;
+    *link = entries[i].next;
+    head = (head + 1) % DEDUP_CAPACITY;
+    count--;
+}
+
+static void expire(double now) {
+    while (count > 0 && entries[head].expires_ms <= now) drop_oldest();
+}
+
+const DedupResult *dedup_lookup(const char *scope, const char *key) {
+    if (!key[0]) return NULL;
+    ensure_init();
+    expire(now_ms());
+    uint64_t h = hash_request(scope, key);
+    for (int i = buckets[bucket_of(h)]; i >= 0; i = entries[i].next) {
+        const DedupEntry *e = &entries[i];
+        if (e->hash == h && strcmp(e->key, key) == 0 && strcmp(e->scope, scope) == 0) return &e->result;
+    }
+    return NULL;
+}
+
+void dedup_remember(const char *scope, const char *key, int code, const char *summary) {
+    if (!key[0]) return;
+    ensure_init();
+    double now = now_ms();
+    expire(now);
+    if (count == DEDUP_CAPACITY) drop_oldest();
+    int i = (head + count) % DEDUP_CAPACITY;
+    DedupEntry *e = &entries[i];
+    e->hash = hash_request(scope, key);
+    snprintf(e->scope, sizeof(e->scope), "%s", scope);
+    snprintf(e->key, sizeof(e->key), "%s", key);
+    e->expires_ms = now + DEDUP_TTL_SECONDS * 1000.0;
+    e->result.code = code;
+    snprintf(e->result.summary, sizeof(e->result.summary), "%s", summary);
+    int b = bucket_of(e->hash);
+    e->next = buckets[b];
+    buckets[b] = i;
+    count++;
+}
+
+void read_request_key(char *key, int n) {
+    printf("Request reference (optional; reuse it if you retry): ");
+    read_line(key, n);
+}
@@ -0,0 +1,30 @@
+#ifndef DEDUP_H
+#define DEDUP_H
+
+/* Idempotency keys for booking and cancel requests. A client that retries
+ * with the same key gets the first attempt's result back instead of a
+ * second booking. Completed requests are remembered in a fixed-size table
+ * for DEDUP_TTL_SECONDS; when it is full the oldest key is forgotten.
+ * Failed attempts are not remembered, so retrying them runs them again. */
+
+#define DEDUP_CAPACITY 1024
+#define DEDUP_TTL_SECONDS 600
+#define DEDUP_MAX_KEY 40
+#define DEDUP_MAX_SUMMARY 200
+
+typedef struct DedupResult {
+    int code;                        /* what the original call returned */
+    char summary[DEDUP_MAX_SUMMARY]; /* shown again on a retry */
+} DedupResult;
+
+/* The result stored for key within scope (e.g. the operation and user),
+ * or NULL if it is new or has expired */
+const DedupResult *dedup_lookup(const char *scope, const char *key);
+
+/* Remember a completed request; an empty key is ignored */
+void dedup_remember(const char *scope, const char *key, int code, const char *summary);
+
+/* Prompt for an optional key; the empty string means none */
+void read_request_key(char *key, int n);
+
+#endif /* DEDUP_H */
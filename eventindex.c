@@ -0,0 +1,281 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "eventindex.h"
+#include "events.h"
+#include "utils.h"
+
+#define GRAM_SYMBOLS 37   /* space, a-z, 0-9 */
+#define GRAM_KEYS (GRAM_SYMBOLS * GRAM_SYMBOLS * GRAM_SYMBOLS)
+#define RESULTS_PAGE_SIZE 10
+
+/* Event numbers in ascending order */
+typedef struct IdList {
+    int *ids;
+    int count;
+    int cap;
+} IdList;
+
+static IdList *grams = NULL;   /* trigram key -> events whose name has it */
+static int *by_date = NULL;    /* event numbers sorted by date, time */
+static int date_count = 0;
+static int date_cap = 0;
+
+/* ============= NAME TRIGRAMS ============= */
+
+/* Lowercase letters and digits; every run of anything else becomes one
+ * space, so "AC/DC" and "ac dc" index and match the same way */
+static void normalize(const char *s, char *out, size_t out_len) {
+    size_t n = 0;
+    for (; *s && n + 1 < out_len; ++s) {
+        unsigned char ch = (unsigned char)*s;
+        if (isalnum(ch)) out[n++] = (char)tolower(ch);
+        else if (n > 0 && out[n - 1] != ' ') out[n++] = ' ';
+    }
+    while (n > 0 && out[n - 1] == ' ') n--;
+    out[n] = '\0';
+}
+
+static int symbol(char ch) {
+    if (ch >= 'a' && ch <= 'z') return 1 + (ch - 'a');
+    if (ch >= '0' && ch <= '9') return 27 + (ch - '0');
+    return 0;
+}
+
+static int gram_key(const char *p) {
+    return (symbol(p[0]) * GRAM_SYMBOLS + symbol(p[1])) * GRAM_SYMBOLS + symbol(p[2]);
+}
+
+static void list_append(IdList *l, int id) {
+    if (l->count > 0 && l->ids[l->count - 1] == id) return;   /* repeated trigram */
+    if (l->count == l->cap) {
+        int cap = l->cap ? l->cap * 2 : 4;
+        int *tmp = (int *)realloc(l->ids, sizeof(int) * (size_t)cap);
+        if (!tmp) { fprintf(stderr, "Memory allocation failed\n"); exit(1); }
+        l->ids = tmp;
+        l->cap = cap;
+    }
+    l->ids[l->count++] = id;
+}
+
+static void index_name(int idx) {
+    char norm[sizeof(event_info[0].name)];
+    normalize(event_info[idx].name, norm, sizeof(norm));
+    for (size_t i = 0; i + 3 <= strlen(norm); ++i) list_append(&grams[gram_key(norm + i)], idx);
+}
+
+/* ============= DATE ORDER ============= */
+
+static int cmp_when(int a, int b) {
+    int c = strcmp(event_info[a].event_date, event_info[b].event_date);
+    if (c == 0) c = strcmp(event_info[a].event_time, event_info[b].event_time);
+    if (c == 0) c = (a > b) - (a < b);
+    return c;
+}
+
+static int cmp_when_qsort(const void *a, const void *b) {
+    return cmp_when(*(const int *)a, *(const int *)b);
+}
+
+/* from and to may be partial dates: "2025-12" as the end of a range
+ * takes in the whole of December */
+static int on_or_after(const char *date, const char *from) {
+    return !from[0] || strcmp(date, from) >= 0;
+}
+
+static int on_or_before(const char *date, const char *to) {
+    return !to[0] || strncmp(date, to, strlen(to)) <= 0;
+}
+
+/* First position in by_date whose date is not before from */
+static int first_on_or_after(const char *from) {
+    int lo = 0, hi = date_count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (on_or_after(event_info[by_date[mid]].event_date, from)) hi = mid;
+        else lo = mid + 1;
+    }
+    return lo;
+}
+
+/* First position in by_date whose date is after to */
+static int first_after(const char *to) {
+    int lo = 0, hi = date_count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (on_or_before(event_info[by_date[mid]].event_date, to)) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+static void ensure_date_capacity(int needed) {
+    if (needed <= date_cap) return;
+    int cap = date_cap ? date_cap : 16;
+    while (cap < needed) cap *= 2;
+    int *tmp = (int *)realloc(by_date, sizeof(int) * (size_t)cap);
+    if (!tmp) { fprintf(stderr, "Memory allocation failed\n"); exit(1); }
+    by_date = tmp;
+    date_cap = cap;
+}
+
+/* ============= MAINTENANCE ============= */
+
+static void ensure_grams(void) {
+    if (grams) return;
+    grams = (IdList *)calloc(GRAM_KEYS, sizeof(IdList));
+    if (!grams) { fprintf(stderr, "Memory allocation failed\n"); exit(1); }
+}
+
+void event_index_rebuild(void) {
+    ensure_grams();
+    for (int k = 0; k < GRAM_KEYS; ++k) grams[k].count = 0;
+    for (int i = 0; i < event_count; ++i) index_name(i);
+    ensure_date_capacity(event_count);
+    for (int i = 0; i < event_count; ++i) by_date[i] = i;
+    qsort(by_date, (size_t)event_count, sizeof(int), cmp_when_qsort);
+    date_count = event_count;
+}
+
+/* New events get the highest number, so posting lists stay sorted by
+ * appending; the date order takes one binary search and a memmove */
+void event_index_add(int event_idx) {
+    ensure_grams();
+    index_name(event_idx);
+    ensure_date_capacity(date_count + 1);
+    int lo = 0, hi = date_count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (cmp_when(by_date[mid], event_idx) < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    memmove(by_date + lo + 1, by_date + lo, sizeof(int) * (size_t)(date_count - lo));
+    by_date[lo] = event_idx;
+    date_count++;
+}
+
+/* Drop the deleted event and renumber the ones after it, which moved down
+ * by one. Order within every list is unchanged. */
+void event_index_remove(int event_idx) {
+    if (!grams) return;
+    for (int k = 0; k < GRAM_KEYS; ++k) {
+        IdList *l = &grams[k];
+        int n = 0;
+        for (int i = 0; i < l->count; ++i) {
+            int id = l->ids[i];
+            if (id == event_idx) continue;
+            l->ids[n++] = id > event_idx ? id - 1 : id;
+        }
+        l->count = n;
+    }
+    int n = 0;
+    for (int i = 0; i < date_count; ++i) {
+        int id = by_date[i];
+        if (id == event_idx) continue;
+        by_date[n++] = id > event_idx ? id - 1 : id;
+    }
+    date_count = n;
+}
+
+void event_index_free(void) {
+    if (grams) {
+        for (int k = 0; k < GRAM_KEYS; ++k) free(grams[k].ids);
+        free(grams);
+        grams = NULL;
+    }
+    free(by_date);
+    by_date = NULL;
+    date_count = date_cap = 0;
+}
+
+/* ============= SEARCH ============= */
+
+static int name_matches(int idx, const char *query) {
+    char norm[sizeof(event_info[0].name)];
+    normalize(event_info[idx].name, norm, sizeof(norm));
+    return strstr(norm, query) != NULL;
+}
+
+/* Candidates come from whichever is narrower: the rarest trigram of the
+ * query, or the date range. Each candidate is then checked against the
+ * full query, since sharing trigrams does not make a substring. */
+int event_search(const char *text, const char *from_date, const char *to_date, int *out) {
+    char query[sizeof(event_info[0].name)];
+    normalize(text, query, sizeof(query));
+    int lo = first_on_or_after(from_date);
+    int hi = first_after(to_date);
+    if (hi < lo) hi = lo;
+
+    const IdList *rarest = NULL;
+    if (grams) {
+        for (size_t i = 0; i + 3 <= strlen(query); ++i) {
+            const IdList *l = &grams[gram_key(query + i)];
+            if (!rarest || l->count < rarest->count) rarest = l;
+        }
+    }
+
+    int n = 0;
+    if (rarest && rarest->count < hi - lo) {
+        for (int i = 0; i < rarest->count; ++i) {
+            int id = rarest->ids[i];
+            const char *date = event_info[id].event_date;
+            if (on_or_after(date, from_date) && on_or_before(date, to_date) && name_matches(id, query)) out[n++] = id;
+        }
+        qsort(out, (size_t)n, sizeof(int), cmp_when_qsort);
+    } else {
+        for (int i = lo; i < hi; ++i) {
+            int id = by_date[i];
+            if (!query[0] || name_matches(id, query)) out[n++] = id;
+        }
+    }
+    return n;
+}
+
+/* ============= INTERACTIVE ============= */
+
+int find_events_interactive(void) {
+    if (event_count == 0) {
+        printf("No events available at the moment. Please check later.\n");
+        return -1;
+    }
+    char text[100], from[20], to[20];
+    printf("\n== Find Events ==\n");
+    printf("Name contains (blank = any): ");
+    read_line(text, sizeof(text));
+    printf("From date YYYY-MM-DD (blank = any): ");
+    read_line(from, sizeof(from));
+    printf("Until date YYYY-MM-DD, inclusive (blank = any): ");
+    read_line(to, sizeof(to));
+
+    int *found = (int *)malloc(sizeof(int) * (size_t)event_count);
+    if (!found) { fprintf(stderr, "Memory allocation failed\n"); exit(1); }
+    int n = event_search(text, from, to, found);
+    if (n == 0) {
+        printf("No events match.\n");
+        free(found);
+        return -1;
+    }
+
+    int pages = (n + RESULTS_PAGE_SIZE - 1) / RESULTS_PAGE_SIZE;
+    int page = 0, picked = -1;
+    while (1) {
+        printf("\n--- %d event%s found, page %d of %d ---\n", n, n == 1 ? "" : "s", page + 1, pages);
+        int end = (page + 1) * RESULTS_PAGE_SIZE < n ? (page + 1) * RESULTS_PAGE_SIZE : n;
+        for (int i = page * RESULTS_PAGE_SIZE; i < end; ++i) print_event_summary(found[i]);
+        printf("%s%sEvent number to book (blank = back): ",
+               page + 1 < pages ? "n) Next page  " : "", page > 0 ? "p) Previous page  " : "");
+        char ans[16];
+        read_line(ans, sizeof(ans));
+        if ((ans[0] == 'n' || ans[0] == 'N') && page + 1 < pages) { page++; continue; }
+        if ((ans[0] == 'p' || ans[0] == 'P') && page > 0) { page--; continue; }
+        if (ans[0]) {
+            int ev = atoi(ans);
+            if (ev >= 1 && ev <= event_count) picked = ev - 1;
+            else printf("Invalid event.\n");
+        }
+        break;
+    }
+    free(found);
+    return picked;
+}
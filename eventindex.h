@@ -0,0 +1,23 @@
+#ifndef EVENTINDEX_H
+#define EVENTINDEX_H
+
+/* Event search: trigram posting lists over event names and event numbers
+ * sorted by date and time. Both are kept in step with create and delete.
+ * Prices and availability are not indexed; they are read from the events
+ * when results are shown, so price changes need no index update. */
+
+void event_index_rebuild(void);
+void event_index_add(int event_idx);
+void event_index_remove(int event_idx);   /* after the events array shifted down */
+void event_index_free(void);
+
+/* Events whose name contains text (case-insensitive, "" = any) and whose
+ * date is within [from_date, to_date] ("" = open end), ordered by date and
+ * time. out needs room for event_count entries; returns the match count. */
+int event_search(const char *text, const char *from_date, const char *to_date, int *out);
+
+/* Search and page through the results; returns the event picked to book
+ * (index into events) or -1 */
+int find_events_interactive(void);
+
+#endif /* EVENTINDEX_H */
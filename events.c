@@ -5,53 +5,186 @@
 #include "events.h"
 #include "bookings.h"
 #include "utils.h"
+#include "persist.h"
+#include "allocator.h"
+#include "columns.h"
+#include "workers.h"
+#include "seatmap.h"
+#include "eventindex.h"
+#include "archive.h"
+#include "waitroom.h"
+#include "bookid.h"
+#include "seatsnap.h"
+#include "purchase.h"
+#include "ratelimit.h"
 
 #define INITIAL_EVENT_CAP 4
 
 Event *events = NULL;
+EventInfo *event_info = NULL;
 int event_count = 0;
 int event_capacity = 0;
 
-int seat_index(const Event *e, int r, int c) {
-    return r * e->cols + c;
+int event_seat_taken(const Event *e, SeatRef s) {
+    return occupancy_test(&e->occ, e->layout, s);
+}
+
+void event_mark_seat(Event *e, SeatRef s) {
+    occupancy_set(&e->occ, e->layout, s);
+    alloc_index_touch(e->alloc, e->layout, s);
+}
+
+void event_release_seat(Event *e, SeatRef s) {
+    occupancy_clear(&e->occ, e->layout, s);
+    alloc_index_touch(e->alloc, e->layout, s);
+}
+
+/* Base price scaled by the seat's price zone */
+double event_seat_price(const Event *e, SeatRef s) {
+    return e->base_price * e->layout->sections[s.section].price_factor;
+}
+
+/* Header-only event: the shared layout and the summary counters, nothing
+ * per seat yet. The event takes over the caller's layout reference. */
+static void setup_event_header(Event *e, VenueLayout *layout) {
+    e->layout = layout;
+    memset(&e->occ, 0, sizeof(e->occ));
+    e->alloc = NULL;
+    e->map = NULL;
+    e->bookings_head = NULL;
+    e->wait_queue = NULL;
+    e->counts = NULL;
+    e->snap = NULL;
+    e->revenue = 0;
+    e->total_bookings = 0;
+    e->materialized = 0;
+}
+
+/* Occupancy bitmap, allocation index and waitlist */
+static void setup_event_seating(Event *e) {
+    if (!occupancy_init(&e->occ, e->layout)) { fprintf(stderr, "Seats allocation failed\n"); exit(1); }
+    e->alloc = alloc_index_create(e->layout);
+    if (!e->alloc) { fprintf(stderr, "Seats allocation failed\n"); exit(1); }
+    e->wait_queue = create_priority_queue(50);  /* initial capacity 50 */
+    e->materialized = 1;
+}
+
+/* Events are loaded as headers; the first operation that needs seats,
+ * bookings or the waitlist builds them, reading the event's bookings from
+ * the startup snapshot. Summary counters stay valid either way. */
+void event_materialize(int event_idx) {
+    Event *e = &events[event_idx];
+    if (e->materialized) return;
+    setup_event_seating(e);
+    e->revenue = 0;
+    e->total_bookings = 0;
+    load_snapshot_bookings(event_idx);
+    seatsnap_publish(e);
+}
+
+/* For reports over every event's seats. Materializing adds an event's
+ * bookings to the columnar store; it is rebuilt afterwards only to put
+ * them back in event order, as after a full load. */
+void materialize_all_events(void) {
+    int loaded = 0;
+    for (int i = 0; i < event_count; ++i) {
+        if (events[i].materialized) continue;
+        event_materialize(i);
+        loaded++;
+    }
+    if (loaded) columns_rebuild();
 }
 
 void init_events_system(void) {
     event_capacity = 0;
     event_count = 0;
     events = NULL;
+    event_info = NULL;
 }
 
 void free_event(Event *e) {
     if (!e) return;
-    free(e->seats);
-    e->seats = NULL;
+    seatsnap_drop(e);
+    occupancy_free(&e->occ);
+    alloc_index_free(e->alloc);
+    e->alloc = NULL;
+    seatmap_free(e->map);
+    e->map = NULL;
+    purchase_counts_free(e->counts);
+    e->counts = NULL;
+    venue_layout_release(e->layout);
+    e->layout = NULL;
+}
+
+/* Drop the events flagged in drop[] together with their bookings and
+ * waitlists, and close the gaps. The remaining events and their bookings
+ * are renumbered; callers rebuild the indexes and persist afterwards.
+ * Returns the number of events removed. */
+int remove_events(const unsigned char *drop) {
+    int n = 0;
+    for (int i = 0; i < event_count; ++i) {
+        Event *e = &events[i];
+        if (drop[i]) {
+            Booking *b = e->bookings_head;
+            while (b) {
+                Booking *next = b->next;
+                free(b);
+                b = next;
+            }
+            free_priority_queue(e->wait_queue);
+            free_event(e);
+            waitroom_free(event_info[i].room);
+            continue;
+        }
+        if (n != i) {
+            events[n] = *e;
+            event_info[n] = event_info[i];
+        }
+        events[n].id = n;
+        for (Booking *b = events[n].bookings_head; b; b = b->next) b->event_id = n;
+        n++;
+    }
+    int removed = event_count - n;
+    event_count = n;
+    return removed;
 }
 
 void cleanup_events_system(void) {
     if (!events) return;
     for (int i = 0; i < event_count; ++i) {
         free_event(&events[i]);
+        waitroom_free(event_info[i].room);
     }
+    seatsnap_cleanup();
     free(events);
+    free(event_info);
     events = NULL;
+    event_info = NULL;
     event_count = 0;
     event_capacity = 0;
 }
 
+/* realloc doesn't keep the cache-line alignment, so the hot array is
+ * moved by hand; the info table grows alongside it */
 int ensure_event_capacity(void) {
-    if (event_capacity == 0) {
-        event_capacity = INITIAL_EVENT_CAP;
-        events = (Event *)calloc(event_capacity, sizeof(Event));
-        if (!events) { fprintf(stderr, "Event allocation failed\n"); exit(1); }
-    } else if (event_count >= event_capacity) {
-        event_capacity *= 2;
-        Event *tmp = (Event *)realloc(events, sizeof(Event) * event_capacity);
-        if (!tmp) { fprintf(stderr, "Event reallocation failed\n"); exit(1); }
-        /* zero-init new tail region */
-        memset(tmp + event_count, 0, sizeof(Event) * (event_capacity - event_count));
-        events = tmp;
+    if (event_count < event_capacity) return 1;
+    int cap = event_capacity ? event_capacity * 2 : INITIAL_EVENT_CAP;
+    void *mem = NULL;
+    if (posix_memalign(&mem, CACHE_LINE, sizeof(Event) * (size_t)cap) != 0) {
+        fprintf(stderr, "Event allocation failed\n");
+        exit(1);
     }
+    Event *tmp = (Event *)mem;
+    if (events) memcpy(tmp, events, sizeof(Event) * (size_t)event_count);
+    /* zero-init new tail region */
+    memset(tmp + event_count, 0, sizeof(Event) * (size_t)(cap - event_count));
+    free(events);
+    events = tmp;
+    EventInfo *info = (EventInfo *)realloc(event_info, sizeof(EventInfo) * (size_t)cap);
+    if (!info) { fprintf(stderr, "Event reallocation failed\n"); exit(1); }
+    memset(info + event_count, 0, sizeof(EventInfo) * (size_t)(cap - event_count));
+    event_info = info;
+    event_capacity = cap;
     return 1;
 }
 
@@ -63,63 +196,127 @@ static void trim(char *s) {
     if (p != s) memmove(s, p, strlen(p)+1);
 }
 
+/* Next '|'-separated field; unlike strtok, empty fields (e.g. no discount
+ * code) are returned as "" so later fields don't shift. NULL at end. */
+static char *next_field(char **cursor) {
+    char *start = *cursor;
+    if (!start) return NULL;
+    char *bar = strchr(start, '|');
+    if (bar) { *bar = 0; *cursor = bar + 1; }
+    else *cursor = NULL;
+    return start;
+}
+
 void load_events_from_file(const char *path) {
     FILE *fp = fopen(path, "r");
     if (!fp) return; /* ok if file absent */
-    char line[512];
+    char line[512 + MAX_LAYOUT_SPEC];
     while (fgets(line, sizeof(line), fp)) {
         trim(line);
         if (!line[0]) continue;
-        /* Format: name|base|rows|cols|code|percent|date|time */
+        /* Format: name|base|rows|cols|code|percent|date|time[|layout[|#no][|rate/burst]]
+         * Sectioned venues store 0|0 for rows|cols and either a layout spec
+         * or @name of a venue template. After it come the event number
+         * and the on-sale waiting room, if the event has one. */
         char name[100], code[32], date[20], etime[10];
         double base = 0;
         int rows = 0, cols = 0, percent = 0;
         char *tok;
         char *rest = line;
 
-        tok = strtok(rest, "|"); if (!tok) continue; strncpy(name, tok, sizeof(name)-1); name[sizeof(name)-1]=0;
-        tok = strtok(NULL, "|"); if (!tok) continue; base = atof(tok);
-        tok = strtok(NULL, "|"); if (!tok) continue; rows = atoi(tok);
-        tok = strtok(NULL, "|"); if (!tok) continue; cols = atoi(tok);
-        tok = strtok(NULL, "|"); if (!tok) continue; strncpy(code, tok, sizeof(code)-1); code[sizeof(code)-1]=0;
-        tok = strtok(NULL, "|"); if (!tok) continue; percent = atoi(tok);
-        tok = strtok(NULL, "|"); 
+        tok = next_field(&rest); if (!tok) continue; strncpy(name, tok, sizeof(name)-1); name[sizeof(name)-1]=0;
+        tok = next_field(&rest); if (!tok) continue; base = atof(tok);
+        tok = next_field(&rest); if (!tok) continue; rows = atoi(tok);
+        tok = next_field(&rest); if (!tok) continue; cols = atoi(tok);
+        tok = next_field(&rest); if (!tok) continue; strncpy(code, tok, sizeof(code)-1); code[sizeof(code)-1]=0;
+        tok = next_field(&rest); if (!tok) continue; percent = atoi(tok);
+        tok = next_field(&rest); 
         if (tok) { strncpy(date, tok, sizeof(date)-1); date[sizeof(date)-1]=0; } else { strcpy(date, "2025-12-31"); }
-        tok = strtok(NULL, "|"); 
+        tok = next_field(&rest); 
         if (tok) { strncpy(etime, tok, sizeof(etime)-1); etime[sizeof(etime)-1]=0; } else { strcpy(etime, "18:00"); }
+        tok = next_field(&rest);
+        VenueLayout *layout;
+        if (tok && tok[0] == '@') layout = venue_template_get(tok + 1);
+        else if (tok && tok[0]) layout = venue_layout_intern(tok);
+        else layout = venue_layout_intern_grid(rows, cols);
+        if (!layout) { fprintf(stderr, "Skipping event '%s': invalid seating layout\n", name); continue; }
+        double admit_rate = 0;
+        int admit_burst = 0;
+        unsigned int event_no = 0;
+        while ((tok = next_field(&rest)) != NULL) {
+            if (tok[0] == '#') event_no = (unsigned int)strtoul(tok + 1, NULL, 10);
+            else if (sscanf(tok, "%lf/%d", &admit_rate, &admit_burst) != 2 || admit_burst < 1) admit_rate = 0;
+        }
+        if (event_no > MAX_EVENT_NUMBER) event_no = 0;
 
         ensure_event_capacity();
         Event *e = &events[event_count];
+        EventInfo *info = &event_info[event_count];
+        memset(info, 0, sizeof(*info));
         e->id = event_count;
-        strncpy(e->name, name, sizeof(e->name)-1); e->name[sizeof(e->name)-1]=0;
+        strncpy(info->name, name, sizeof(info->name)-1); info->name[sizeof(info->name)-1]=0;
         e->base_price = base;
-        e->rows = rows;
-        e->cols = cols;
-        strncpy(e->discount_code, code, sizeof(e->discount_code)-1); e->discount_code[sizeof(e->discount_code)-1]=0;
-        e->discount_percent = percent;
-        strncpy(e->event_date, date, sizeof(e->event_date)-1); e->event_date[sizeof(e->event_date)-1]=0;
-        strncpy(e->event_time, etime, sizeof(e->event_time)-1); e->event_time[sizeof(e->event_time)-1]=0;
-        e->revenue = 0;
-        e->total_bookings = 0;
-        e->bookings_head = NULL;
-        e->wait_queue = create_priority_queue(50);
-        size_t nseats = (size_t)rows * (size_t)cols;
-        e->seats = (int *)calloc(nseats, sizeof(int));
-        if (!e->seats) { fprintf(stderr, "Seats allocation failed\n"); exit(1); }
+        strncpy(info->discount_code, code, sizeof(info->discount_code)-1); info->discount_code[sizeof(info->discount_code)-1]=0;
+        info->discount_percent = percent;
+        strncpy(info->event_date, date, sizeof(info->event_date)-1); info->event_date[sizeof(info->event_date)-1]=0;
+        strncpy(info->event_time, etime, sizeof(info->event_time)-1); info->event_time[sizeof(info->event_time)-1]=0;
+        info->event_no = event_no;
+        setup_event_header(e, layout);
+        if (admit_rate > 0) info->room = waitroom_create(admit_rate, admit_burst);
         event_count++;
     }
     fclose(fp);
 }
 
-void save_events_to_file(const char *path) {
-    FILE *fp = fopen(path, "w");
-    if (!fp) { printf("Failed to open %s for write\n", path); return; }
-    for (int i = 0; i < event_count; ++i) {
-        Event *e = &events[i];
-        fprintf(fp, "%s|%.2f|%d|%d|%s|%d|%s|%s\n", e->name, e->base_price, e->rows, e->cols, 
-                e->discount_code, e->discount_percent, e->event_date, e->event_time);
+/* One event in events.txt record format */
+void format_event_record(TextBuf *tb, int event_idx) {
+    const Event *e = &events[event_idx];
+    const EventInfo *info = &event_info[event_idx];
+    int layout_field = 1;
+    if (e->layout->name[0]) {
+        tb_printf(tb, "%s|%.2f|0|0|%s|%d|%s|%s|@%s", info->name, e->base_price,
+                info->discount_code, info->discount_percent, info->event_date, info->event_time, e->layout->name);
+    } else if (venue_is_grid(e->layout)) {
+        tb_printf(tb, "%s|%.2f|%d|%d|%s|%d|%s|%s", info->name, e->base_price,
+                e->layout->sections[0].rows, e->layout->sections[0].cols,
+                info->discount_code, info->discount_percent, info->event_date, info->event_time);
+        layout_field = 0;
+    } else {
+        char spec[MAX_LAYOUT_SPEC];
+        venue_layout_format(e->layout, spec, sizeof(spec));
+        tb_printf(tb, "%s|%.2f|0|0|%s|%d|%s|%s|%s", info->name, e->base_price,
+                info->discount_code, info->discount_percent, info->event_date, info->event_time, spec);
     }
-    fclose(fp);
+    /* A grid has no layout field, so it gets an empty one before the rest */
+    if (!layout_field) tb_append(tb, "|", 1);
+    tb_printf(tb, "|#%u", info->event_no);
+    if (info->room) tb_printf(tb, "|%g/%d", info->room->rate, info->room->burst);
+    tb_append(tb, "\n", 1);
+}
+
+void save_events_to_file(const char *path) {
+    /* Serialize on this thread; the snapshot writer does the file I/O */
+    TextBuf tb;
+    tb_init(&tb, (size_t)event_count * 160);
+    for (int i = 0; i < event_count; ++i) format_event_record(&tb, i);
+    submit_snapshot(path, &tb);
+}
+
+/* Two-line listing entry, numbered as customers pick events */
+void print_event_summary(int i) {
+    const EventInfo *info = &event_info[i];
+    printf(" %d) %s - %s @ %s\n", i + 1, info->name, info->event_date, info->event_time);
+    const VenueLayout *v = events[i].layout;
+    char seats_desc[48];
+    if (v->name[0]) snprintf(seats_desc, sizeof(seats_desc), "%d at %s", v->total_seats, v->name);
+    else if (v->section_count == 1) snprintf(seats_desc, sizeof(seats_desc), "%dx%d", v->sections[0].rows, v->sections[0].cols);
+    else snprintf(seats_desc, sizeof(seats_desc), "%d in %d sections", v->total_seats, v->section_count);
+    seatsnap_read_begin();
+    const SeatSnapshot *s = seatsnap_get(&events[i]);
+    printf("    Price: Rs.%.2f (%.0f%% full) | Seats: %s | Code: %s - %d%%\n",
+        s ? s->base_price : events[i].base_price, get_occupancy_percent(i), seats_desc, 
+        info->discount_code, info->discount_percent);
+    seatsnap_read_end();
 }
 
 void list_events_brief(void) {
@@ -128,18 +325,71 @@ void list_events_brief(void) {
         return;
     }
     printf("\nAvailable Events:\n");
-    for (int i = 0; i < event_count; ++i) {
-        printf(" %d) %s - %s @ %s\n", i + 1, events[i].name, events[i].event_date, events[i].event_time);
-        printf("    Price: Rs.%.2f (%.0f%% full) | Seats: %dx%d | Code: %s - %d%%\n",
-            events[i].base_price, get_occupancy_percent(i), events[i].rows, events[i].cols, 
-            events[i].discount_code, events[i].discount_percent);
+    for (int i = 0; i < event_count; ++i) print_event_summary(i);
+}
+
+/* Ask for each section of a multi-section venue; fills a layout spec */
+static int read_sections_interactive(char *spec, size_t spec_len) {
+    printf("Number of sections (1-%d): ", MAX_SECTIONS);
+    int n = read_int();
+    if (n < 1 || n > MAX_SECTIONS) { printf("Invalid section count.\n"); return 0; }
+    size_t used = 0;
+    spec[0] = '\0';
+    for (int i = 0; i < n; ++i) {
+        char sname[MAX_SECTION_NAME + 8], buf[64], aisles[128], access[MAX_ACCESS_SPEC];
+        printf("Section %d name (letters/digits, e.g. FLOOR, L101): ", i + 1);
+        read_line(sname, sizeof(sname));
+        printf("  Tier (0 = floor, 1 = lower, 2 = upper...): ");
+        int tier = read_int();
+        printf("  Rows (1-%d): ", MAX_SECTION_ROWS);
+        int rows = read_int();
+        printf("  Seats per row (1-%d): ", MAX_SECTION_COLS);
+        int cols = read_int();
+        printf("  Price zone multiplier (e.g. 1.0, 1.5, 0.75): ");
+        read_line(buf, sizeof(buf));
+        double factor = atof(buf);
+        printf("  Aisles after seat numbers (e.g. 10,20; empty for none): ");
+        read_line(aisles, sizeof(aisles));
+        printf("  Accessible rows/seats (e.g. A,B1,B2; empty for none): ");
+        read_line(access, sizeof(access));
+        int w = snprintf(spec + used, spec_len - used, "%s%s/%d:%dx%d@%.2f%s%s%s%s",
+                         i ? ";" : "", sname, tier, rows, cols, factor,
+                         aisles[0] ? "+aisle=" : "", aisles, access[0] ? "+access=" : "", access);
+        if (w < 0 || (size_t)w >= spec_len - used) { printf("Layout too long.\n"); return 0; }
+        used += (size_t)w;
+    }
+    return 1;
+}
+
+static void print_invalid_layout(void) {
+    printf("Invalid layout (unique alphanumeric names, rows 1-%d, seats per row 1-%d, up to %d seats).\n",
+           MAX_SECTION_ROWS, MAX_SECTION_COLS, MAX_VENUE_SEATS);
+}
+
+void manage_venue_templates_interactive(void) {
+    list_venue_templates();
+    printf("\n1) Create template\n2) Back\nChoose: ");
+    if (read_int() != 1) return;
+    char name[MAX_TEMPLATE_NAME + 8], spec[MAX_LAYOUT_SPEC];
+    printf("Template name (letters, digits, '-' or '_'): ");
+    read_line(name, sizeof(name));
+    if (!read_sections_interactive(spec, sizeof(spec))) return;
+    VenueLayout *existing = venue_template_get(name);
+    if (existing) {
+        venue_layout_release(existing);
+        printf("A template named %s already exists.\n", name);
+        return;
     }
+    if (!venue_template_define(name, spec)) { print_invalid_layout(); return; }
+    save_venue_templates("venues.txt");
+    printf("Venue template %s created.\n", name);
 }
 
 int create_event_interactive(void) {
     char name[100], code[32], buf[64];
     int rows, cols, percent;
     double base;
+    VenueLayout *layout;
 
     printf("\n== Create Event ==\n");
     printf("Event name: ");
@@ -151,13 +401,31 @@ int create_event_interactive(void) {
     base = atof(buf);
     if (base <= 0) { printf("Invalid price.\n"); return 0; }
 
-    printf("Rows: ");
-    rows = read_int();
-    if (rows <= 0 || rows > 26) { printf("Rows must be 1..26\n"); return 0; }
+    printf("Venue layout: 1) Single seating grid  2) Sections (arena/stadium)  3) Venue template\nChoose: ");
+    int layout_choice = read_int();
+    if (layout_choice == 2) {
+        char spec[MAX_LAYOUT_SPEC];
+        if (!read_sections_interactive(spec, sizeof(spec))) return 0;
+        layout = venue_layout_intern(spec);
+        if (!layout) { print_invalid_layout(); return 0; }
+    } else if (layout_choice == 3) {
+        char tname[MAX_TEMPLATE_NAME + 8];
+        list_venue_templates();
+        printf("Template name: ");
+        read_line(tname, sizeof(tname));
+        layout = venue_template_get(tname);
+        if (!layout) { printf("No such venue template.\n"); return 0; }
+    } else {
+        printf("Rows: ");
+        rows = read_int();
+        if (rows <= 0 || rows > MAX_SECTION_ROWS) { printf("Rows must be 1..%d\n", MAX_SECTION_ROWS); return 0; }
 
-    printf("Columns: ");
-    cols = read_int();
-    if (cols <= 0 || cols > 50) { printf("Columns must be 1..50\n"); return 0; }
+        printf("Columns: ");
+        cols = read_int();
+        if (cols <= 0 || cols > MAX_SECTION_COLS) { printf("Columns must be 1..%d\n", MAX_SECTION_COLS); return 0; }
+        layout = venue_layout_intern_grid(rows, cols);
+        if (!layout) { printf("Venue too large (max %d seats).\n", MAX_VENUE_SEATS); return 0; }
+    }
 
     printf("Event date (YYYY-MM-DD): ");
     char date[20];
@@ -179,23 +447,21 @@ int create_event_interactive(void) {
 
     ensure_event_capacity();
     Event *e = &events[event_count];
+    EventInfo *info = &event_info[event_count];
+    memset(info, 0, sizeof(*info));
     e->id = event_count;
-    strncpy(e->name, name, sizeof(e->name)-1); e->name[sizeof(e->name)-1]=0;
+    strncpy(info->name, name, sizeof(info->name)-1); info->name[sizeof(info->name)-1]=0;
     e->base_price = base;
-    e->rows = rows;
-    e->cols = cols;
-    strncpy(e->discount_code, code, sizeof(e->discount_code)-1); e->discount_code[sizeof(e->discount_code)-1]=0;
-    e->discount_percent = percent;
-    strncpy(e->event_date, date, sizeof(e->event_date)-1); e->event_date[sizeof(e->event_date)-1]=0;
-    strncpy(e->event_time, etime, sizeof(e->event_time)-1); e->event_time[sizeof(e->event_time)-1]=0;
-    e->revenue = 0;
-    e->total_bookings = 0;
-    e->bookings_head = NULL;
-    e->wait_queue = create_priority_queue(50);  /* initial capacity 50 */
-    size_t nseats = (size_t)rows * (size_t)cols;
-    e->seats = (int *)calloc(nseats, sizeof(int));
-    if (!e->seats) { fprintf(stderr, "Seats allocation failed\n"); exit(1); }
+    strncpy(info->discount_code, code, sizeof(info->discount_code)-1); info->discount_code[sizeof(info->discount_code)-1]=0;
+    info->discount_percent = percent;
+    strncpy(info->event_date, date, sizeof(info->event_date)-1); info->event_date[sizeof(info->event_date)-1]=0;
+    strncpy(info->event_time, etime, sizeof(info->event_time)-1); info->event_time[sizeof(info->event_time)-1]=0;
+    info->event_no = next_event_number();
+    setup_event_header(e, layout);
+    setup_event_seating(e);
+    seatsnap_publish(e);
     event_count++;
+    event_index_add(event_count - 1);
 
     save_events_to_file("events.txt");
     printf("Event created.\n");
@@ -210,14 +476,14 @@ void delete_event_interactive(void) {
     ev -= 1;
     if (ev < 0 || ev >= event_count) { printf("Invalid event.\n"); return; }
 
-    /* free resources for this event */
-    free_event(&events[ev]);
-    /* shift remaining */
-    for (int i = ev; i < event_count - 1; ++i) {
-        events[i] = events[i+1];
-        events[i].id = i;
-    }
-    event_count--;
+    /* free this event and shift the rest down (renumbering their bookings) */
+    unsigned char *drop = (unsigned char *)calloc((size_t)event_count, 1);
+    if (!drop) { fprintf(stderr, "Memory allocation failed\n"); exit(1); }
+    drop[ev] = 1;
+    remove_events(drop);
+    free(drop);
+    event_index_remove(ev);
+    columns_rebuild();
     save_events_to_file("events.txt");
     printf("Event deleted.\n");
 }
@@ -228,73 +494,59 @@ void change_ticket_price_interactive(void) {
     printf("Enter event number to modify price: ");
     int ev = read_int(); ev -= 1;
     if (ev < 0 || ev >= event_count) { printf("Invalid event.\n"); return; }
-    printf("Current base price for %s = Rs.%.2f\n", events[ev].name, events[ev].base_price);
+    printf("Current base price for %s = Rs.%.2f\n", event_info[ev].name, events[ev].base_price);
     printf("Enter new base price (positive): ");
     char buf[64];
     read_line(buf, sizeof(buf));
     double p = atof(buf);
     if (p <= 0) { printf("Invalid price.\n"); return; }
     events[ev].base_price = p;
+    seatsnap_publish(&events[ev]);
     save_events_to_file("events.txt");
-    printf("Price updated for %s. New base price = Rs.%.2f\n", events[ev].name, events[ev].base_price);
+    printf("Price updated for %s. New base price = Rs.%.2f\n", event_info[ev].name, events[ev].base_price);
 }
 
+/* Seat map of one event into tb. Only touches this event (and its map
+ * cache), so maps of different events can be rendered on worker threads;
+ * the event must already be materialized. */
+void render_seat_map(int event_idx, TextBuf *tb) {
+    if (event_idx < 0 || event_idx >= event_count) return;
+    const TextBuf *map = seatmap_get(&events[event_idx], event_info[event_idx].name);
+    tb_append(tb, map->data, map->len);
+}
+
+/* An unchanged map is a single fwrite of the cached text */
 void display_seat_map(int event_idx) {
     if (event_idx < 0 || event_idx >= event_count) return;
-    Event *e = &events[event_idx];
-    double occ = get_occupancy_percent(event_idx);
-    
-    printf("\n+============================================================+\n");
-    printf("|  Seat Map: %s\n", e->name);
-    printf("|  Price: Rs.%.2f (%.0f%% full)\n", e->base_price, occ);
-    printf("+============================================================+\n");
-    printf("\n");
-    
-    /* Print column numbers */
-    printf("     ");
-    for (int c = 0; c < e->cols; ++c) {
-        printf(" %3d ", c + 1);
-    }
-    printf("\n");
-    
-    /* Print seats in [A1] format */
-    for (int r = 0; r < e->rows; ++r) {
-        printf("  %c  ", 'A' + r);
-        for (int c = 0; c < e->cols; ++c) {
-            int idx = seat_index(e, r, c);
-            if (e->seats[idx]) {
-                printf("[XXX]");
-            } else {
-                printf("[%c%2d]", 'A' + r, c + 1);
-            }
-        }
-        printf("\n");
-    }
-    printf("\n  Legend: [XXX] = Booked  |  [A 1] = Available\n");
+    event_materialize(event_idx);
+    const TextBuf *map = seatmap_get(&events[event_idx], event_info[event_idx].name);
+    fwrite(map->data, 1, map->len, stdout);
 }
 
+int get_total_seats(int event_idx) {
+    if (event_idx < 0 || event_idx >= event_count) return 0;
+    return events[event_idx].layout->total_seats;
+}
+
+/* As last published, for display */
 int get_seats_booked(int event_idx) {
     if (event_idx < 0 || event_idx >= event_count) return 0;
-    Event *e = &events[event_idx];
-    int count = 0;
-    for (int i = 0; i < e->rows * e->cols; ++i) {
-        if (e->seats[i]) count++;
-    }
-    return count;
+    seatsnap_read_begin();
+    const SeatSnapshot *s = seatsnap_get(&events[event_idx]);
+    int booked = s ? s->booked : events[event_idx].occ.booked;
+    seatsnap_read_end();
+    return booked;
 }
 
+/* Live, for the booking path */
 int get_available_seat_count(int event_idx) {
     if (event_idx < 0 || event_idx >= event_count) return 0;
-    Event *e = &events[event_idx];
-    int total = e->rows * e->cols;
-    int booked = get_seats_booked(event_idx);
-    return total - booked;
+    return get_total_seats(event_idx) - events[event_idx].occ.booked;
 }
 
 double get_occupancy_percent(int event_idx) {
     if (event_idx < 0 || event_idx >= event_count) return 0.0;
-    Event *e = &events[event_idx];
-    int total = e->rows * e->cols;
+    int total = get_total_seats(event_idx);
     if (total == 0) return 0.0;
     int booked = get_seats_booked(event_idx);
     return (booked * 100.0) / total;
@@ -302,41 +554,65 @@ double get_occupancy_percent(int event_idx) {
 
 
 
+/* Each event's figures come from one published copy, so they agree with
+ * each other even while bookings go on */
+static void render_event_analytics(int i, TextBuf *tb, void *ctx) {
+    (void)ctx;
+    seatsnap_read_begin();
+    const SeatSnapshot *s = seatsnap_get(&events[i]);
+    int booked = s->booked;
+    int total = get_total_seats(i);
+    double occ = total ? (booked * 100.0) / total : 0.0;
+    
+    tb_printf(tb, "Event: %s\n", event_info[i].name);
+    tb_printf(tb, "  Total Bookings: %d\n", s->total_bookings);
+    tb_printf(tb, "  Seats Booked: %d / %d (%.1f%%)\n", booked, total, occ);
+    int orphans = s->orphans, runs = s->runs;
+    if (runs > 0) {
+        tb_printf(tb, "  Fragmentation: %d orphan single seat%s, %d free block%s (avg %.1f seats)\n",
+                  orphans, orphans == 1 ? "" : "s", runs, runs == 1 ? "" : "s",
+                  (double)(total - booked) / runs);
+    }
+    tb_printf(tb, "  Revenue: Rs.%.2f\n", s->revenue);
+    tb_printf(tb, "  Base Price: Rs.%.2f\n\n", s->base_price);
+    seatsnap_read_end();
+}
+
 void show_booking_analytics(void) {
     if (event_count == 0) {
         printf("\nNo events available for analytics.\n");
+        show_archive_summary();
         return;
     }
     
+    /* Fragmentation and the trends need every event's seats and bookings */
+    materialize_all_events();
     printf("\n+============================================================+\n");
     printf("|              BOOKING ANALYTICS REPORT                      |\n");
     printf("+============================================================+\n\n");
     
+    /* Per-event sections are rendered on the worker pool */
+    parallel_render(event_count, render_event_analytics, NULL, stdout);
+    
     int most_popular_idx = 0;
-    int max_bookings = events[0].total_bookings;
+    int max_bookings = -1;
     double total_revenue = 0.0;
-    
+    seatsnap_read_begin();
     for (int i = 0; i < event_count; ++i) {
-        Event *e = &events[i];
-        int booked = get_seats_booked(i);
-        int total = e->rows * e->cols;
-        double occ = get_occupancy_percent(i);
-        
-        printf("Event: %s\n", e->name);
-        printf("  Total Bookings: %d\n", e->total_bookings);
-        printf("  Seats Booked: %d / %d (%.1f%%)\n", booked, total, occ);
-        printf("  Revenue: Rs.%.2f\n", e->revenue);
-        printf("  Base Price: Rs.%.2f\n\n", e->base_price);
-        
-        total_revenue += e->revenue;
-        if (e->total_bookings > max_bookings) {
-            max_bookings = e->total_bookings;
+        const SeatSnapshot *s = seatsnap_get(&events[i]);
+        total_revenue += s->revenue;
+        if (s->total_bookings > max_bookings) {
+            max_bookings = s->total_bookings;
             most_popular_idx = i;
         }
     }
+    seatsnap_read_end();
     
     printf("===========================================================\n");
-    printf("Most Popular Event: %s (%d bookings)\n", events[most_popular_idx].name, max_bookings);
+    printf("Most Popular Event: %s (%d bookings)\n", event_info[most_popular_idx].name, max_bookings);
     printf("Total Revenue (All Events): Rs.%.2f\n", total_revenue);
+    show_booking_trends();
+    show_rate_limit_summary();
+    show_archive_summary();
     printf("===========================================================\n");
 }
\ No newline at end of file
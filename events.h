@@ -2,29 +2,58 @@
 #define EVENTS_H
 
 #include <stdio.h>
+#include "venue.h"
+#include "utils.h"
 
 struct Booking;
 struct QueueNode;
+struct AllocIndex;
+struct SeatMapCache;
+struct WaitRoom;
+struct PurchaseCounts;
+struct SeatSnapshot;
 
+#define CACHE_LINE 64
+
+/* Per-event state used by booking, seat allocation and the occupancy
+ * scans behind listings and analytics. Two cache lines, with the summary
+ * figures those scans read in the first; names, dates and the discount
+ * are in event_info[] at the same index. */
 typedef struct Event {
+    /* first line: summary figures */
+    VenueLayout *layout;   /* sections, rows and price zones */
+    double base_price;
+    double revenue;
+    int total_bookings;   /* for analytics */
+    int materialized;     /* 0 = header only: no bitmap, index, waitlist or bookings yet */
+    SeatOccupancy occ;     /* booked-seat bitmap and counters */
+    /* second line: per-seat indexes and bookings */
+    struct AllocIndex *alloc; /* best-available block index */
+    struct SeatMapCache *map; /* rendered seat map, built on first view */
+    struct Booking *bookings_head;   // use struct tag here
+    struct PriorityQueue *wait_queue;  // replaced linked list with priority queue
+    struct PurchaseCounts *counts; /* seats per user and phone, while limits are set */
+    struct SeatSnapshot *snap;     /* published copy for readers, see seatsnap.h */
     int id;
+} __attribute__((aligned(CACHE_LINE))) Event;
+
+/* Descriptive fields of an event, read when it is printed, booked with a
+ * discount code or saved */
+typedef struct EventInfo {
     char name[100];
-    double base_price;
-    int rows;
-    int cols;
     char discount_code[32];
     int discount_percent;
-    int *seats;
-    struct Booking *bookings_head;   // use struct tag here
-    struct PriorityQueue *wait_queue;  // replaced linked list with priority queue
-    double revenue;
     char event_date[20];  /* format: YYYY-MM-DD */
     char event_time[10];  /* format: HH:MM */
-    int total_bookings;   /* for analytics */
-} Event;
+    unsigned int event_no; /* stable number, carried in booking IDs */
+    long snap_offset;     /* this event's records in the startup bookings snapshot */
+    long snap_len;
+    struct WaitRoom *room; /* on-sale admission control, NULL = open booking */
+} EventInfo;
 
 /* Globals for events */
 extern Event *events;
+extern EventInfo *event_info;
 extern int event_count;
 extern int event_capacity;
 
@@ -32,22 +61,33 @@ extern int event_capacity;
 void init_events_system(void);
 void free_event(Event *e);
 void cleanup_events_system(void);
+void event_materialize(int event_idx);
+void materialize_all_events(void);
+int remove_events(const unsigned char *drop);
 
 /* Persistence */
 void load_events_from_file(const char *path);
 void save_events_to_file(const char *path);
+void format_event_record(TextBuf *tb, int event_idx);
 
 /* Admin operations */
 int create_event_interactive(void);
 void list_events_brief(void);
+void print_event_summary(int event_idx);
 void delete_event_interactive(void);
 void change_ticket_price_interactive(void);
 void display_seat_map(int event_idx);
+void render_seat_map(int event_idx, TextBuf *tb);
 void show_booking_analytics(void);
+void manage_venue_templates_interactive(void);
 
 /* Helpers */
 int ensure_event_capacity(void);
-int seat_index(const Event *e, int r, int c);
+int event_seat_taken(const Event *e, SeatRef s);
+void event_mark_seat(Event *e, SeatRef s);
+void event_release_seat(Event *e, SeatRef s);
+double event_seat_price(const Event *e, SeatRef s);
+int get_total_seats(int event_idx);
 int get_seats_booked(int event_idx);
 int get_available_seat_count(int event_idx);
 double get_occupancy_percent(int event_idx);
@@ -0,0 +1,196 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include "journal.h"
+#include "utils.h"
+
+int journal_batch_bytes = JOURNAL_DEFAULT_BATCH_BYTES;
+int journal_max_delay_ms = JOURNAL_DEFAULT_MAX_DELAY_MS;
+
+static pthread_mutex_t jlock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t flusher_wake = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t durable_cond = PTHREAD_COND_INITIALIZER;
+static pthread_t flusher_tid;
+static int jfd = -1;
+static int flusher_running = 0;
+static int flusher_stopping = 0;
+static int journal_failed = 0;
+static int flushing = 0;          /* a batch is being written outside the lock */
+
+static TextBuf active;            /* records appended since the last swap */
+static struct timespec active_since;
+static unsigned long appended_lsn = 0;  /* last record appended */
+static unsigned long durable_lsn = 0;   /* last record fsynced */
+static long file_size = 0;
+
+static void deadline_after(const struct timespec *start, int ms, struct timespec *out) {
+    *out = *start;
+    out->tv_sec += ms / 1000;
+    out->tv_nsec += (long)(ms % 1000) * 1000000L;
+    if (out->tv_nsec >= 1000000000L) { out->tv_sec++; out->tv_nsec -= 1000000000L; }
+}
+
+static int write_all(int fd, const char *data, size_t len) {
+    size_t off = 0;
+    while (off < len) {
+        ssize_t w = write(fd, data + off, len - off);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            return 0;
+        }
+        off += (size_t)w;
+    }
+    return 1;
+}
+
+static void *flusher_main(void *arg) {
+    (void)arg;
+    TextBuf batch;
+    tb_init(&batch, (size_t)journal_batch_bytes);
+    pthread_mutex_lock(&jlock);
+    while (1) {
+        /* Wait for a full batch, the latency bound, or shutdown */
+        while (!flusher_stopping && (active.len == 0 || (int)active.len < journal_batch_bytes)) {
+            if (active.len == 0) {
+                pthread_cond_wait(&flusher_wake, &jlock);
+            } else {
+                struct timespec deadline;
+                deadline_after(&active_since, journal_max_delay_ms, &deadline);
+                if (pthread_cond_timedwait(&flusher_wake, &jlock, &deadline) == ETIMEDOUT) break;
+            }
+        }
+        if (active.len == 0) {
+            if (flusher_stopping) break;
+            continue;
+        }
+
+        /* Swap buffers so appenders can continue while this batch is written */
+        TextBuf tmp = batch; batch = active; active = tmp;
+        active.len = 0;
+        active.data[0] = '\0';
+        unsigned long batch_lsn = appended_lsn;
+        int fd = jfd;
+        flushing = 1;
+        pthread_mutex_unlock(&jlock);
+
+        int ok = write_all(fd, batch.data, batch.len) && fsync(fd) == 0;
+
+        pthread_mutex_lock(&jlock);
+        if (ok) {
+            file_size += (long)batch.len;
+            if (batch_lsn > durable_lsn) durable_lsn = batch_lsn;
+        } else {
+            fprintf(stderr, "Journal write failed: %s\n", strerror(errno));
+            journal_failed = 1;
+        }
+        batch.len = 0;
+        flushing = 0;
+        pthread_cond_broadcast(&durable_cond);
+    }
+    pthread_mutex_unlock(&jlock);
+    tb_free(&batch);
+    return NULL;
+}
+
+int journal_open(const char *path) {
+    if (flusher_running) return 1;
+    jfd = open(path, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (jfd < 0) return 0;
+    file_size = (long)lseek(jfd, 0, SEEK_END);
+    tb_init(&active, (size_t)journal_batch_bytes);
+    journal_failed = 0;
+    flusher_stopping = 0;
+    if (pthread_create(&flusher_tid, NULL, flusher_main, NULL) != 0) {
+        close(jfd);
+        jfd = -1;
+        tb_free(&active);
+        return 0;
+    }
+    flusher_running = 1;
+    return 1;
+}
+
+void journal_close(void) {
+    if (!flusher_running) return;
+    pthread_mutex_lock(&jlock);
+    flusher_stopping = 1;
+    pthread_cond_signal(&flusher_wake);
+    pthread_mutex_unlock(&jlock);
+    pthread_join(flusher_tid, NULL);
+    flusher_running = 0;
+    close(jfd);
+    jfd = -1;
+    tb_free(&active);
+}
+
+int journal_is_open(void) {
+    return flusher_running && !journal_failed;
+}
+
+unsigned long journal_append(const char *records, size_t len) {
+    pthread_mutex_lock(&jlock);
+    if (active.len == 0) clock_gettime(CLOCK_REALTIME, &active_since);
+    tb_append(&active, records, len);
+    unsigned long lsn = ++appended_lsn;
+    pthread_cond_signal(&flusher_wake);
+    pthread_mutex_unlock(&jlock);
+    return lsn;
+}
+
+int journal_wait(unsigned long lsn) {
+    pthread_mutex_lock(&jlock);
+    while (durable_lsn < lsn && !journal_failed) pthread_cond_wait(&durable_cond, &jlock);
+    int ok = (durable_lsn >= lsn);
+    pthread_mutex_unlock(&jlock);
+    return ok;
+}
+
+int journal_commit(const char *records, size_t len) {
+    if (!journal_is_open()) return 0;
+    return journal_wait(journal_append(records, len));
+}
+
+void journal_reset(void) {
+    if (!flusher_running) return;
+    pthread_mutex_lock(&jlock);
+    while (flushing) pthread_cond_wait(&durable_cond, &jlock);
+    /* Records still buffered are covered by the snapshot, so they count as durable */
+    active.len = 0;
+    active.data[0] = '\0';
+    if (ftruncate(jfd, 0) == 0) {
+        fsync(jfd);
+        file_size = 0;
+    }
+    durable_lsn = appended_lsn;
+    pthread_cond_broadcast(&durable_cond);
+    pthread_mutex_unlock(&jlock);
+}
+
+long journal_size(void) {
+    pthread_mutex_lock(&jlock);
+    long n = file_size;
+    pthread_mutex_unlock(&jlock);
+    return n;
+}
+
+int journal_replay(const char *path, void (*apply)(char *line, void *ctx), void *ctx) {
+    FILE *fp = fopen(path, "r");
+    if (!fp) return 0;
+    int count = 0;
+    char line[1024];
+    while (fgets(line, sizeof(line), fp)) {
+        size_t n = strlen(line);
+        if (n == 0 || line[n-1] != '\n') break;  /* torn tail */
+        line[n-1] = '\0';
+        if (!line[0]) continue;
+        apply(line, ctx);
+        count++;
+    }
+    fclose(fp);
+    return count;
+}
@@ -0,0 +1,36 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <stddef.h>
+
+#define JOURNAL_DEFAULT_BATCH_BYTES (64 * 1024)
+#define JOURNAL_DEFAULT_MAX_DELAY_MS 5
+#define JOURNAL_CHECKPOINT_BYTES (8L * 1024 * 1024)
+
+/* Group commit tuning: a batch is flushed once it holds journal_batch_bytes
+ * or its oldest record has waited journal_max_delay_ms (the latency bound). */
+extern int journal_batch_bytes;
+extern int journal_max_delay_ms;
+
+/* Journal lifecycle: open starts the flusher thread */
+int journal_open(const char *path);
+void journal_close(void);
+int journal_is_open(void);
+
+/* Append one or more newline-terminated records and wait until the batch
+ * holding them is fsynced. Returns 1 once durable, 0 on failure. */
+int journal_commit(const char *records, size_t len);
+
+/* Lower-level pieces of journal_commit() */
+unsigned long journal_append(const char *records, size_t len);
+int journal_wait(unsigned long lsn);
+
+/* Drop all records (call only after a snapshot covering them is durable) */
+void journal_reset(void);
+long journal_size(void);
+
+/* Feed every complete line of the journal at path to apply(); a torn
+ * trailing line from a crash is ignored. Returns the number of records. */
+int journal_replay(const char *path, void (*apply)(char *line, void *ctx), void *ctx);
+
+#endif /* JOURNAL_H */
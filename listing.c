@@ -0,0 +1,267 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "listing.h"
+#include "columns.h"
+#include "events.h"
+#include "utils.h"
+
+#define EXPORT_BUFFER_SIZE (1 << 20)
+#define DEFAULT_PAGE_SIZE 50
+
+/* ============= DATE FORMATTING ============= */
+
+/* Formats "YYYY-MM-DD HH:MM" with one localtime_r per local hour: the
+ * "YYYY-MM-DD HH:" prefix is reused for any timestamp that falls in the
+ * same local hour as the cached one, and only the minutes are filled in. */
+typedef struct DateCache {
+    int64_t hour_start;   /* first second of the cached local hour */
+    char prefix[16];
+    int valid;
+} DateCache;
+
+static void format_time(DateCache *dc, int64_t ts, char out[17]) {
+    if (!dc->valid || ts < dc->hour_start || ts >= dc->hour_start + 3600) {
+        struct tm tm_info;
+        time_t t = (time_t)ts;
+        localtime_r(&t, &tm_info);
+        strftime(dc->prefix, sizeof(dc->prefix), "%Y-%m-%d %H:", &tm_info);
+        dc->hour_start = ts - tm_info.tm_min * 60 - tm_info.tm_sec;
+        dc->valid = 1;
+    }
+    int min = (int)((ts - dc->hour_start) / 60);
+    memcpy(out, dc->prefix, 14);
+    out[14] = (char)('0' + min / 10);
+    out[15] = (char)('0' + min % 10);
+    out[16] = '\0';
+}
+
+/* ============= FILTERS AND CURSORS ============= */
+
+void filter_init(BookingFilter *f) {
+    f->event = FILTER_ANY;
+    f->user = FILTER_ANY;
+    f->from = INT64_MIN;
+    f->to = INT64_MAX;
+}
+
+/* Restrict to one customer; returns 0 (and matches nothing) if they have
+ * no bookings at all */
+int filter_set_user(BookingFilter *f, const char *username) {
+    f->user = dict_find(&booking_cols.users, username);
+    if (f->user >= 0) return 1;
+    f->user = FILTER_NONE;
+    return 0;
+}
+
+void cursor_init(BookingCursor *cur) {
+    cur->pos = 0;
+    cur->generation = booking_cols.generation;
+}
+
+static int matches(const BookingColumns *c, const BookingFilter *f, int i) {
+    return c->live[i] &&
+           (f->event == FILTER_ANY || c->event[i] == f->event) &&
+           (f->user == FILTER_ANY || c->user[i] == f->user) &&
+           c->timestamp[i] >= f->from && c->timestamp[i] < f->to;
+}
+
+int list_bookings_page(const BookingFilter *f, BookingCursor *cur, int page_size, FILE *out) {
+    const BookingColumns *c = &booking_cols;
+    if (cur->generation != c->generation) return -1;
+    if (cur->pos < 0) return 0;
+    DateCache dc = { 0, "", 0 };
+    int rows = 0;
+    int i = cur->pos;
+    for (; i < c->count && rows < page_size; ++i) {
+        if (!matches(c, f, i)) continue;
+        char when[17], seat[MAX_SEAT_LABEL];
+        format_time(&dc, c->timestamp[i], when);
+        SeatRef sr = { c->section[i], c->row[i], c->col[i] };
+        format_seat_label(events[c->event[i]].layout, sr, seat, sizeof(seat));
+        fprintf(out, " - ID: %s | %s | %s | seat %s | Rs.%.2f | %s | phone: %s\n",
+                c->groups.names[c->group[i]], event_info[c->event[i]].name, c->users.names[c->user[i]],
+                seat, c->price[i], when, c->phones.names[c->phone[i]]);
+        rows++;
+    }
+    /* Done when nothing further matches; peek ahead so the last page says so */
+    while (i < c->count && !matches(c, f, i)) i++;
+    cur->pos = i < c->count ? i : -1;
+    return rows;
+}
+
+/* ============= EXPORT ============= */
+
+static void csv_field(FILE *fp, const char *s) {
+    if (!strpbrk(s, ",\"\n")) { fputs(s, fp); return; }
+    fputc('"', fp);
+    for (; *s; ++s) {
+        if (*s == '"') fputc('"', fp);
+        fputc(*s, fp);
+    }
+    fputc('"', fp);
+}
+
+static void json_string(FILE *fp, const char *s) {
+    fputc('"', fp);
+    for (; *s; ++s) {
+        unsigned char ch = (unsigned char)*s;
+        if (ch == '"' || ch == '\\') { fputc('\\', fp); fputc(ch, fp); }
+        else if (ch < 0x20) fprintf(fp, "\\u%04x", ch);
+        else fputc(ch, fp);
+    }
+    fputc('"', fp);
+}
+
+long export_bookings(const BookingFilter *f, const char *path, int json) {
+    FILE *fp = fopen(path, "w");
+    if (!fp) return -1;
+    char *buf = (char *)malloc(EXPORT_BUFFER_SIZE);
+    if (buf) setvbuf(fp, buf, _IOFBF, EXPORT_BUFFER_SIZE);
+
+    const BookingColumns *c = &booking_cols;
+    DateCache dc = { 0, "", 0 };
+    long rows = 0;
+    if (json) fputs("[\n", fp);
+    else fputs("booking_id,event,event_date,username,phone,seat,price,booked_at\n", fp);
+    for (int i = 0; i < c->count; ++i) {
+        if (!matches(c, f, i)) continue;
+        const Event *ev = &events[c->event[i]];
+        const EventInfo *info = &event_info[c->event[i]];
+        char when[17], seat[MAX_SEAT_LABEL];
+        format_time(&dc, c->timestamp[i], when);
+        SeatRef sr = { c->section[i], c->row[i], c->col[i] };
+        format_seat_label(ev->layout, sr, seat, sizeof(seat));
+        if (json) {
+            fputs(rows ? ",\n  {\"booking_id\": " : "  {\"booking_id\": ", fp);
+            json_string(fp, c->groups.names[c->group[i]]);
+            fputs(", \"event\": ", fp); json_string(fp, info->name);
+            fputs(", \"event_date\": ", fp); json_string(fp, info->event_date);
+            fputs(", \"username\": ", fp); json_string(fp, c->users.names[c->user[i]]);
+            fputs(", \"phone\": ", fp); json_string(fp, c->phones.names[c->phone[i]]);
+            fprintf(fp, ", \"seat\": \"%s\", \"price\": %.2f, \"booked_at\": \"%s\"}", seat, c->price[i], when);
+        } else {
+            csv_field(fp, c->groups.names[c->group[i]]); fputc(',', fp);
+            csv_field(fp, info->name); fputc(',', fp);
+            fputs(info->event_date, fp); fputc(',', fp);
+            csv_field(fp, c->users.names[c->user[i]]); fputc(',', fp);
+            csv_field(fp, c->phones.names[c->phone[i]]);
+            fprintf(fp, ",%s,%.2f,%s\n", seat, c->price[i], when);
+        }
+        rows++;
+    }
+    if (json) fputs(rows ? "\n]\n" : "]\n", fp);
+    int failed = ferror(fp);
+    if (fclose(fp) != 0) failed = 1;
+    free(buf);
+    return failed ? -1 : rows;
+}
+
+/* ============= INTERACTIVE ============= */
+
+/* "YYYY-MM-DD" to local midnight; returns 0 if malformed */
+static int parse_day(const char *s, int64_t *out) {
+    int y, m, d;
+    if (sscanf(s, "%4d-%2d-%2d", &y, &m, &d) != 3 || m < 1 || m > 12 || d < 1 || d > 31) return 0;
+    struct tm tm_info;
+    memset(&tm_info, 0, sizeof(tm_info));
+    tm_info.tm_year = y - 1900;
+    tm_info.tm_mon = m - 1;
+    tm_info.tm_mday = d;
+    tm_info.tm_isdst = -1;
+    time_t t = mktime(&tm_info);
+    if (t == (time_t)-1) return 0;
+    *out = (int64_t)t;
+    return 1;
+}
+
+/* Ask for event, booking date range and customer; returns 0 on bad input.
+ * The username is kept so it can be re-resolved after a store rebuild. */
+static int read_filter(BookingFilter *f, char *username, int username_len) {
+    char line[64];
+    filter_init(f);
+    materialize_all_events();
+    list_events_brief();
+    printf("Event number (0 = all events): ");
+    int ev = read_int();
+    if (ev < 0 || ev > event_count) { printf("Invalid event.\n"); return 0; }
+    f->event = ev == 0 ? FILTER_ANY : ev - 1;
+
+    printf("Booked from date YYYY-MM-DD (blank = any): ");
+    read_line(line, sizeof(line));
+    if (line[0] && !parse_day(line, &f->from)) { printf("Invalid date.\n"); return 0; }
+    printf("Booked until date YYYY-MM-DD, inclusive (blank = any): ");
+    read_line(line, sizeof(line));
+    if (line[0]) {
+        if (!parse_day(line, &f->to)) { printf("Invalid date.\n"); return 0; }
+        f->to += 24 * 3600;
+    }
+
+    printf("Username (blank = all customers): ");
+    read_line(username, username_len);
+    if (username[0]) filter_set_user(f, username);
+    return 1;
+}
+
+void browse_bookings_interactive(void) {
+    BookingFilter f;
+    char username[64];
+    if (!read_filter(&f, username, sizeof(username))) return;
+    char line[16];
+    printf("Page size (blank = %d, 0 = everything at once): ", DEFAULT_PAGE_SIZE);
+    read_line(line, sizeof(line));
+    int page_size = line[0] ? atoi(line) : DEFAULT_PAGE_SIZE;
+    if (page_size < 0) page_size = DEFAULT_PAGE_SIZE;
+    if (page_size == 0 && f.event == FILTER_ANY && f.user == FILTER_ANY && f.from == INT64_MIN && f.to == INT64_MAX) {
+        show_all_bookings_admin();
+        return;
+    }
+    if (page_size == 0) page_size = booking_cols.count + 1;
+
+    BookingCursor cur;
+    cursor_init(&cur);
+    int page = 1, shown = 0;
+    while (1) {
+        printf("\n--- Page %d ---\n", page);
+        int rows = list_bookings_page(&f, &cur, page_size, stdout);
+        if (rows < 0) {
+            /* Bookings were compacted or an event removed: start over */
+            printf("Booking list changed; restarting from the first page.\n");
+            if (username[0]) filter_set_user(&f, username);
+            cursor_init(&cur);
+            page = 1;
+            shown = 0;
+            continue;
+        }
+        shown += rows;
+        if (cur.pos < 0) {
+            if (shown == 0) printf(" (none)\n");
+            printf("(%d booking%s shown)\n", shown, shown == 1 ? "" : "s");
+            return;
+        }
+        printf("n) Next page  q) Done: ");
+        char ans[8];
+        read_line(ans, sizeof(ans));
+        if (ans[0] != 'n' && ans[0] != 'N') return;
+        page++;
+    }
+}
+
+void export_bookings_interactive(void) {
+    BookingFilter f;
+    char username[64];
+    if (!read_filter(&f, username, sizeof(username))) return;
+    printf("Format: 1) CSV  2) JSON: ");
+    int fmt = read_int();
+    if (fmt != 1 && fmt != 2) { printf("Invalid format.\n"); return; }
+    char path[256];
+    printf("Output file (blank = bookings_export.%s): ", fmt == 2 ? "json" : "csv");
+    read_line(path, sizeof(path));
+    if (!path[0]) snprintf(path, sizeof(path), "bookings_export.%s", fmt == 2 ? "json" : "csv");
+
+    double start = now_ms();
+    long rows = export_bookings(&f, path, fmt == 2);
+    if (rows < 0) { printf("Could not write %s.\n", path); return; }
+    printf("Exported %ld booking%s to %s in %.0f ms.\n", rows, rows == 1 ? "" : "s", path, now_ms() - start);
+}
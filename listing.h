@@ -0,0 +1,41 @@
+#ifndef LISTING_H
+#define LISTING_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#define FILTER_ANY (-1)
+#define FILTER_NONE (-2)
+
+/* Which bookings a listing or export covers */
+typedef struct BookingFilter {
+    int event;      /* event index or FILTER_ANY */
+    int user;       /* users dict id, FILTER_ANY or FILTER_NONE */
+    int64_t from;   /* booked at or after (inclusive) */
+    int64_t to;     /* booked before (exclusive) */
+} BookingFilter;
+
+/* Position in the columnar booking store. New bookings are appended, so a
+ * cursor stays valid while bookings come in; a store rebuild (event delete,
+ * compaction) bumps the generation and the cursor must restart. */
+typedef struct BookingCursor {
+    int pos;        /* next column entry to examine, -1 when done */
+    unsigned generation;
+} BookingCursor;
+
+void filter_init(BookingFilter *f);
+int filter_set_user(BookingFilter *f, const char *username);
+void cursor_init(BookingCursor *cur);
+
+/* Write up to page_size matching bookings and advance the cursor.
+ * Returns rows written, or -1 if the cursor went stale. */
+int list_bookings_page(const BookingFilter *f, BookingCursor *cur, int page_size, FILE *out);
+
+/* Stream every matching booking to path as CSV or a JSON array.
+ * Returns rows written, or -1 if the file can't be written. */
+long export_bookings(const BookingFilter *f, const char *path, int json);
+
+void browse_bookings_interactive(void);
+void export_bookings_interactive(void);
+
+#endif /* LISTING_H */
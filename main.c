@@ -1,9 +1,26 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "utils.h"
 #include "users.h"
 #include "events.h"
 #include "bookings.h"
+#include "workers.h"
+#include "startup.h"
+#include "persist.h"
+#include "journal.h"
+#include "allocator.h"
+#include "columns.h"
+#include "listing.h"
+#include "eventindex.h"
+#include "archive.h"
+#include "waitroom.h"
+#include "purchase.h"
+#include "ratelimit.h"
+#include "dedup.h"
+#include "bookid.h"
+#include "seatsnap.h"
+#include "shard.h"
 
 static void customer_portal_flow(User *user) {
     while (1) {
@@ -11,7 +28,7 @@ static void customer_portal_flow(User *user) {
         printf("+============================================================+\n");
         printf("|       CUSTOMER PORTAL - %s\n", user->username);
         printf("+============================================================+\n");
-        printf("1) Book seats\n2) Cancel seats\n3) View my bookings\n4) Exit\nChoose: ");
+        printf("1) Book seats\n2) Cancel seats\n3) View my bookings\n4) Find events (name/date range)\n5) Swap a seat\n6) Book two events together\n7) Exit\nChoose: ");
         int ch = read_int();
         if (ch == 1) {
             if (event_count == 0) {
@@ -24,11 +41,7 @@ static void customer_portal_flow(User *user) {
             int ev = read_int(); ev -= 1;
             if (ev < 0 || ev >= event_count) { printf("Invalid event.\n"); pause_enter(); continue; }
             int res = book_seat_for_user(ev, user);
-            if (res == 1) {
-                save_bookings_to_file("bookings.txt");
-                save_events_to_file("events.txt");
-            }
-            (void)res;
+            if (res == 1) persist_booking_change();
             pause_enter();
         } else if (ch == 2) {
             if (event_count == 0) { printf("No events.\n"); pause_enter(); continue; }
@@ -38,15 +51,33 @@ static void customer_portal_flow(User *user) {
             if (ev < 0 || ev >= event_count) { printf("Invalid event.\n"); pause_enter(); continue; }
             int ok = cancel_seat_by_user(ev, user);
             if (!ok) printf("No cancellation performed.\n");
-            else {
-                save_bookings_to_file("bookings.txt");
-                save_events_to_file("events.txt");
-            }
+            else persist_booking_change();
             pause_enter();
         } else if (ch == 3) {
             view_my_bookings(user);
             pause_enter();
         } else if (ch == 4) {
+            int ev = find_events_interactive();
+            if (ev >= 0 && book_seat_for_user(ev, user) == 1) persist_booking_change();
+            pause_enter();
+        } else if (ch == 5) {
+            if (event_count == 0) { printf("No events.\n"); pause_enter(); continue; }
+            list_events_brief();
+            printf("Enter event number to swap a seat in: ");
+            int ev = read_int(); ev -= 1;
+            if (ev < 0 || ev >= event_count) { printf("Invalid event.\n"); pause_enter(); continue; }
+            if (swap_seat_by_user(ev, user)) persist_booking_change();
+            pause_enter();
+        } else if (ch == 6) {
+            if (event_count < 2) { printf("Fewer than two events are on sale.\n"); pause_enter(); continue; }
+            list_events_brief();
+            printf("First event number: ");
+            int first = read_int() - 1;
+            printf("Second event number: ");
+            int second = read_int() - 1;
+            if (book_two_events_for_user(first, second, user)) persist_booking_change();
+            pause_enter();
+        } else if (ch == 7) {
             printf("Exiting customer portal.\n");
             break;
         } else {
@@ -65,14 +96,18 @@ static void admin_portal_flow(User *user) {
         printf("2) Create event\n");
         printf("3) Delete event\n");
         printf("4) Display full seat map (all events)\n");
-        printf("5) View all bookings (all events)\n");
+        printf("5) Browse bookings (filter, page)\n");
         printf("6) View waiting queue (choose event)\n");
         printf("7) Booking Analytics\n");
         printf("8) Search bookings\n");
         printf("9) Cancel booking by ID\n");
         printf("10) View customer database\n");
         printf("11) Change ticket prices\n");
-        printf("12) Exit\nChoose: ");
+        printf("12) Venue templates\n");
+        printf("13) Export bookings (CSV/JSON)\n");
+        printf("14) Archive past events\n");
+        printf("15) On-sale waiting rooms\n");
+        printf("16) Exit\nChoose: ");
         int ch = read_int();
         if (ch == 1) {
             list_events_brief();
@@ -84,13 +119,14 @@ static void admin_portal_flow(User *user) {
         } else if (ch == 3) {
             delete_event_interactive();
             save_events_to_file("events.txt");
-            save_bookings_to_file("bookings.txt");
+            /* Event indexes shift on delete, so journal records can't be replayed past it */
+            checkpoint_bookings("bookings.txt");
             pause_enter();
         } else if (ch == 4) {
             show_full_seatmap_all_events();
             pause_enter();
         } else if (ch == 5) {
-            show_all_bookings_admin();
+            browse_bookings_interactive();
             pause_enter();
         } else if (ch == 6) {
             if (event_count == 0) { printf("No events.\n"); pause_enter(); continue; }
@@ -110,11 +146,10 @@ static void admin_portal_flow(User *user) {
             printf("Enter Booking ID to cancel: ");
             char bid[32];
             read_line(bid, sizeof(bid));
-            int cancelled = cancel_booking_by_id(bid);
-            if (cancelled) {
-                save_bookings_to_file("bookings.txt");
-                save_events_to_file("events.txt");
-            }
+            char key[DEDUP_MAX_KEY];
+            read_request_key(key, sizeof(key));
+            int cancelled = cancel_booking_by_id(bid, key);
+            if (cancelled) persist_booking_change();
             pause_enter();
         } else if (ch == 10) {
             printf("\n+============================================================+\n");
@@ -133,6 +168,18 @@ static void admin_portal_flow(User *user) {
             save_events_to_file("events.txt");
             pause_enter();
         } else if (ch == 12) {
+            manage_venue_templates_interactive();
+            pause_enter();
+        } else if (ch == 13) {
+            export_bookings_interactive();
+            pause_enter();
+        } else if (ch == 14) {
+            archive_events_interactive();
+            pause_enter();
+        } else if (ch == 15) {
+            waitroom_configure_interactive();
+            pause_enter();
+        } else if (ch == 16) {
             printf("Exiting admin portal.\n");
             break;
         } else {
@@ -141,15 +188,84 @@ static void admin_portal_flow(User *user) {
     }
 }
 
-int main(void) {
+int main(int argc, char **argv) {
+    int parallel_load = 0;
+    int threads_given = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--parallel-load") == 0) {
+            parallel_load = 1;
+        } else if (strcmp(argv[i], "--commit-delay-ms") == 0 && i + 1 < argc) {
+            journal_max_delay_ms = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--commit-batch-bytes") == 0 && i + 1 < argc) {
+            journal_batch_bytes = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            worker_threads = atoi(argv[++i]);
+            threads_given = 1;
+        } else if (strcmp(argv[i], "--seat-policy") == 0 && i + 1 < argc && strcmp(argv[i + 1], "best") == 0) {
+            alloc_policy = ALLOC_POLICY_BEST;
+            i++;
+        } else if (strcmp(argv[i], "--seat-policy") == 0 && i + 1 < argc && strcmp(argv[i + 1], "compact") == 0) {
+            alloc_policy = ALLOC_POLICY_COMPACT;
+            i++;
+        } else if (strcmp(argv[i], "--max-seats-per-user") == 0 && i + 1 < argc) {
+            max_seats_per_user = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--max-seats-per-phone") == 0 && i + 1 < argc) {
+            max_seats_per_phone = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--no-rate-limits") == 0) {
+            rate_limits_enabled = 0;
+        } else if (strcmp(argv[i], "--shards") == 0 && i + 1 < argc) {
+            shard_count = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "Usage: %s [--parallel-load] [--threads N] [--commit-delay-ms MS] [--commit-batch-bytes N] [--seat-policy best|compact] [--max-seats-per-user N] [--max-seats-per-phone N] [--no-rate-limits] [--shards N]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (worker_threads < 1) worker_threads = 1;
+    if (journal_max_delay_ms < 0) journal_max_delay_ms = 0;
+    if (journal_batch_bytes < 1) journal_batch_bytes = 1;
+    if (max_seats_per_user < 0) max_seats_per_user = 0;
+    if (max_seats_per_phone < 0) max_seats_per_phone = 0;
+    if (!threads_given) worker_threads = default_worker_threads();
+
     init_events_system();
     ensure_user_capacity();
+    if (shard_count > 0) return run_sharded();
+    load_venue_templates("venues.txt");
+
+    if (parallel_load) {
+        parallel_startup_load("events.txt", "bookings.txt", "users.txt");
+    } else {
+        load_events_from_file("events.txt");
 
-    load_events_from_file("events.txt");
+        /* With a current index, events stay headers until first used */
+        if (!open_bookings_snapshot("bookings.txt")) {
+            materialize_all_events();
+            load_bookings_from_file("bookings.txt");
+        }
+        
+        load_users_from_file("users.txt");
+    }
+    archive_load_index("archive.dat");
+    if (booking_ids_load("ids.dat")) save_events_to_file("events.txt");
+
+    int replayed = replay_bookings_journal("bookings.journal");
+    seatsnap_publish_all();
+    columns_rebuild();
+    event_index_rebuild();
+
+    start_snapshot_writer();
+    if (!journal_open("bookings.journal")) {
+        printf("Warning: journal unavailable, saving full snapshots instead.\n");
+    } else if (replayed > 0 || journal_size() > 0) {
+        /* Fold the journal into a snapshot, so nothing new is appended
+         * after a record a crash cut short */
+        if (replayed > 0) printf("Recovered %d booking change%s from the journal.\n", replayed, replayed > 1 ? "s" : "");
+        checkpoint_bookings("bookings.txt");
+    }
 
-    load_bookings_from_file("bookings.txt");
-    
-    load_users_from_file("users.txt");
+    /* Keep only upcoming events in memory */
+    int archived = archive_past_events();
+    if (archived > 0) printf("Archived %d finished event%s to archive.dat.\n", archived, archived > 1 ? "s" : "");
 
     printf("Welcome to Concert Booking System\n");
     print_divider();
@@ -203,8 +319,10 @@ int main(void) {
             printf("Exiting program. Goodbye.\n");
             /* Save all data before exiting */
             save_events_to_file("events.txt");
-            save_bookings_to_file("bookings.txt");
+            checkpoint_bookings("bookings.txt");
             save_users_to_file("users.txt");
+            journal_close();
+            stop_snapshot_writer();
             break;
         } else {
             printf("Invalid option.\n");
@@ -212,7 +330,12 @@ int main(void) {
     }
 
 
+    columns_free();
+    event_index_free();
+    archive_free();
+    close_bookings_snapshot();
     cleanup_events_system();
+    cleanup_venue_templates();
     free(users);
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,160 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "persist.h"
+
+#define WRITE_CHUNK (1 << 20)   /* bytes per write() call */
+#define MAX_PENDING_SNAPSHOTS 16
+#define MAX_PATH_LEN 256
+
+typedef struct SnapshotJob {
+    char path[MAX_PATH_LEN];
+    TextBuf buf;
+} SnapshotJob;
+
+static pthread_mutex_t writer_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t writer_wake = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t writer_idle = PTHREAD_COND_INITIALIZER;
+static pthread_t writer_tid;
+static int writer_running = 0;
+static int writer_stopping = 0;
+static int writer_busy = 0;
+static SnapshotJob pending[MAX_PENDING_SNAPSHOTS];
+static int pending_count = 0;
+static int write_failures = 0;      /* failed writes since the last wait */
+
+static int fsync_parent_dir(const char *path) {
+    char dir[MAX_PATH_LEN];
+    const char *slash = strrchr(path, '/');
+    if (!slash) {
+        strcpy(dir, ".");
+    } else {
+        size_t n = (size_t)(slash - path);
+        if (n == 0) n = 1;  /* file in root */
+        if (n >= sizeof(dir)) return 0;
+        memcpy(dir, path, n);
+        dir[n] = '\0';
+    }
+    int fd = open(dir, O_RDONLY);
+    if (fd < 0) return 0;
+    int ok = (fsync(fd) == 0);
+    close(fd);
+    return ok;
+}
+
+int write_file_atomic(const char *path, const char *data, size_t len) {
+    char tmp[MAX_PATH_LEN + 8];
+    if (strlen(path) >= MAX_PATH_LEN) return 0;
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+
+    int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return 0;
+    size_t off = 0;
+    while (off < len) {
+        size_t n = len - off;
+        if (n > WRITE_CHUNK) n = WRITE_CHUNK;
+        ssize_t w = write(fd, data + off, n);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            close(fd);
+            unlink(tmp);
+            return 0;
+        }
+        off += (size_t)w;
+    }
+    if (fsync(fd) != 0) { close(fd); unlink(tmp); return 0; }
+    if (close(fd) != 0) { unlink(tmp); return 0; }
+    if (rename(tmp, path) != 0) { unlink(tmp); return 0; }
+    fsync_parent_dir(path);
+    return 1;
+}
+
+static void *writer_main(void *arg) {
+    (void)arg;
+    pthread_mutex_lock(&writer_lock);
+    while (1) {
+        while (pending_count == 0 && !writer_stopping) pthread_cond_wait(&writer_wake, &writer_lock);
+        if (pending_count == 0 && writer_stopping) break;
+
+        /* Take the oldest job and write it without holding the lock */
+        SnapshotJob job = pending[0];
+        memmove(&pending[0], &pending[1], sizeof(SnapshotJob) * (size_t)(pending_count - 1));
+        pending_count--;
+        writer_busy = 1;
+        pthread_mutex_unlock(&writer_lock);
+
+        if (!write_file_atomic(job.path, job.buf.data, job.buf.len)) {
+            fprintf(stderr, "Failed to write snapshot %s: %s\n", job.path, strerror(errno));
+            pthread_mutex_lock(&writer_lock);
+            write_failures++;
+            pthread_mutex_unlock(&writer_lock);
+        }
+        tb_free(&job.buf);
+
+        pthread_mutex_lock(&writer_lock);
+        writer_busy = 0;
+        if (pending_count == 0) pthread_cond_broadcast(&writer_idle);
+    }
+    pthread_mutex_unlock(&writer_lock);
+    return NULL;
+}
+
+void start_snapshot_writer(void) {
+    if (writer_running) return;
+    writer_stopping = 0;
+    if (pthread_create(&writer_tid, NULL, writer_main, NULL) == 0) writer_running = 1;
+}
+
+int wait_for_snapshots(void) {
+    pthread_mutex_lock(&writer_lock);
+    while (writer_running && (pending_count > 0 || writer_busy)) pthread_cond_wait(&writer_idle, &writer_lock);
+    int ok = (write_failures == 0);
+    write_failures = 0;
+    pthread_mutex_unlock(&writer_lock);
+    return ok;
+}
+
+void stop_snapshot_writer(void) {
+    if (!writer_running) return;
+    pthread_mutex_lock(&writer_lock);
+    writer_stopping = 1;
+    pthread_cond_signal(&writer_wake);
+    pthread_mutex_unlock(&writer_lock);
+    pthread_join(writer_tid, NULL);
+    writer_running = 0;
+}
+
+void submit_snapshot(const char *path, TextBuf *buf) {
+    if (!writer_running || strlen(path) >= MAX_PATH_LEN) {
+        if (!write_file_atomic(path, buf->data, buf->len)) {
+            printf("Failed to write %s\n", path);
+            pthread_mutex_lock(&writer_lock);
+            write_failures++;
+            pthread_mutex_unlock(&writer_lock);
+        }
+        tb_free(buf);
+        return;
+    }
+    pthread_mutex_lock(&writer_lock);
+    /* Coalesce: only the newest snapshot of a file matters */
+    for (int i = 0; i < pending_count; ++i) {
+        if (strcmp(pending[i].path, path) == 0) {
+            tb_free(&pending[i].buf);
+            pending[i].buf = *buf;
+            buf->data = NULL;
+            pthread_mutex_unlock(&writer_lock);
+            return;
+        }
+    }
+    while (pending_count >= MAX_PENDING_SNAPSHOTS) pthread_cond_wait(&writer_idle, &writer_lock);
+    SnapshotJob *job = &pending[pending_count++];
+    strcpy(job->path, path);
+    job->buf = *buf;
+    buf->data = NULL;
+    pthread_cond_signal(&writer_wake);
+    pthread_mutex_unlock(&writer_lock);
+}
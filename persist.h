@@ -0,0 +1,25 @@
+#ifndef PERSIST_H
+#define PERSIST_H
+
+#include <stddef.h>
+#include "utils.h"
+
+/* Write data to path crash-safely: write path.tmp, fsync it, rename it over
+ * path and fsync the directory. Returns 1 on success, 0 on failure (the old
+ * file is left untouched). */
+int write_file_atomic(const char *path, const char *data, size_t len);
+
+/* Background snapshot writer */
+void start_snapshot_writer(void);
+void stop_snapshot_writer(void);   /* drains pending snapshots first */
+
+/* Block until every submitted snapshot is on disk. Returns 1 if all writes
+ * since the previous call succeeded. */
+int wait_for_snapshots(void);
+
+/* Hand a serialized snapshot to the writer; takes ownership of buf.
+ * A newer snapshot of the same path replaces one still waiting. Without a
+ * running writer the snapshot is written synchronously. */
+void submit_snapshot(const char *path, TextBuf *buf);
+
+#endif /* PERSIST_H */
@@ -0,0 +1,86 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include "purchase.h"
+#include "events.h"
+
+int max_seats_per_user = 0;
+int max_seats_per_phone = 0;
+
+/* FNV-1a; keys are compared by hash alone, which at 64 bits only merges
+ * two customers' counts by astronomically rare accident */
+static uint64_t key_of(const char *s) {
+    uint64_t h = 1469598103934665603ULL;
+    for (; *s; ++s) {
+        h ^= (unsigned char)*s;
+        h *= 1099511628211ULL;
+    }
+    return h ? h : 1;
+}
+
+static CountSlot *probe(const CountMap *m, uint64_t key) {
+    unsigned int mask = (unsigned int)m->slot_count - 1;
+    unsigned int i = (unsigned int)(key ^ (key >> 32)) & mask;
+    while (m->slots[i].key && m->slots[i].key != key) i = (i + 1) & mask;
+    return &m->slots[i];
+}
+
+static void map_grow(CountMap *m) {
+    CountMap bigger;
+    bigger.slot_count = m->slot_count ? m->slot_count * 2 : 16;
+    bigger.used = m->used;
+    bigger.slots = (CountSlot *)calloc((size_t)bigger.slot_count, sizeof(CountSlot));
+    if (!bigger.slots) { fprintf(stderr, "Memory allocation failed\n"); exit(1); }
+    for (int i = 0; i < m->slot_count; ++i)
+        if (m->slots[i].key) *probe(&bigger, m->slots[i].key) = m->slots[i];
+    free(m->slots);
+    *m = bigger;
+}
+
+static void map_add(CountMap *m, const char *s, int seats) {
+    if ((m->used + 1) * 4 > m->slot_count * 3) map_grow(m);   /* load <= 3/4 */
+    uint64_t key = key_of(s);
+    CountSlot *slot = probe(m, key);
+    if (!slot->key) {
+        slot->key = key;
+        m->used++;
+    }
+    slot->seats += seats;
+}
+
+static int map_get(const CountMap *m, const char *s) {
+    if (!m->slot_count) return 0;
+    return probe(m, key_of(s))->seats;
+}
+
+void purchase_count(int event_idx, const char *username, const char *phone, int seats) {
+    if (!max_seats_per_user && !max_seats_per_phone) return;
+    Event *e = &events[event_idx];
+    if (!e->counts) {
+        e->counts = (PurchaseCounts *)calloc(1, sizeof(PurchaseCounts));
+        if (!e->counts) { fprintf(stderr, "Memory allocation failed\n"); exit(1); }
+    }
+    if (max_seats_per_user) map_add(&e->counts->by_user, username, seats);
+    if (max_seats_per_phone && phone[0]) map_add(&e->counts->by_phone, phone, seats);
+}
+
+int purchase_allowance(int event_idx, const char *username, const char *phone) {
+    const PurchaseCounts *pc = events[event_idx].counts;
+    int left = INT_MAX;
+    if (max_seats_per_user) {
+        int held = pc ? map_get(&pc->by_user, username) : 0;
+        left = max_seats_per_user - held;
+    }
+    if (max_seats_per_phone && phone[0]) {
+        int held = pc ? map_get(&pc->by_phone, phone) : 0;
+        if (max_seats_per_phone - held < left) left = max_seats_per_phone - held;
+    }
+    return left > 0 ? left : 0;
+}
+
+void purchase_counts_free(PurchaseCounts *pc) {
+    if (!pc) return;
+    free(pc->by_user.slots);
+    free(pc->by_phone.slots);
+    free(pc);
+}
@@ -0,0 +1,39 @@
+#ifndef PURCHASE_H
+#define PURCHASE_H
+
+#include <stdint.h>
+
+/* Purchase limits: the most seats one account, or one phone number across
+ * accounts, may hold for a single event. 0 = no limit. */
+extern int max_seats_per_user;
+extern int max_seats_per_phone;
+
+/* Open-addressing map from a 64-bit hash of a username or phone to the
+ * seats it holds. Slots are never removed; a count can drop to zero. */
+typedef struct CountSlot {
+    uint64_t key;   /* 0 = empty */
+    int seats;
+} CountSlot;
+
+typedef struct CountMap {
+    CountSlot *slots;
+    int slot_count;   /* power of two */
+    int used;
+} CountMap;
+
+/* Seats held per user and per phone for one event; kept only while a
+ * limit is set, built up as the event's bookings are applied */
+typedef struct PurchaseCounts {
+    CountMap by_user;
+    CountMap by_phone;
+} PurchaseCounts;
+
+/* Record seats booked (positive) or released (negative) */
+void purchase_count(int event_idx, const char *username, const char *phone, int seats);
+
+/* Seats username (with this phone) may still book for the event */
+int purchase_allowance(int event_idx, const char *username, const char *phone);
+
+void purchase_counts_free(PurchaseCounts *pc);
+
+#endif /* PURCHASE_H */
@@ -0,0 +1,161 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include "ratelimit.h"
+#include "utils.h"
+
+#define SLICES 6                     /* the window is kept as 10-second slices */
+#define SLICE_MS (RATE_WINDOW_SECONDS * 1000.0 / SLICES)
+#define SKETCH_ROWS 4
+#define SKETCH_WIDTH 1024            /* power of two */
+#define HEAVY_SLOTS 64
+
+int rate_limits_enabled = 1;
+
+/* Attempts allowed per window, by kind */
+static const int limits[RATE_KINDS] = { 5, 20, 10, 20, 30 };
+static const char *const kind_names[RATE_KINDS] = {
+    "sign-in/user", "sign-in/session", "booking/user", "booking/phone", "booking/session"
+};
+
+static uint16_t sketch[SLICES][SKETCH_ROWS][SKETCH_WIDTH];
+
+typedef struct HeavyHitter {
+    uint64_t key;      /* 0 = free */
+    RateKind kind;
+    char label[32];    /* start of the key, for the report */
+    uint16_t counts[SLICES];
+    long rejected;
+} HeavyHitter;
+
+static HeavyHitter heavy[HEAVY_SLOTS];
+static long slice_now = -1;          /* index of the current slice since start */
+static long rejected_total[RATE_KINDS];
+
+static uint64_t hash_key(RateKind kind, const char *key) {
+    uint64_t h = 1469598103934665603ULL ^ (uint64_t)kind;
+    for (; *key; ++key) {
+        h ^= (unsigned char)*key;
+        h *= 1099511628211ULL;
+    }
+    return h ? h : 1;
+}
+
+/* Row r's cell: double hashing from the two halves of the key */
+static unsigned int cell(uint64_t h, int r) {
+    uint32_t a = (uint32_t)h, b = (uint32_t)(h >> 32) | 1;
+    return (a + (uint32_t)r * b) & (SKETCH_WIDTH - 1);
+}
+
+/* Move to the current slice, clearing the ones that fell out of the window */
+static void advance(void) {
+    long s = (long)(now_ms() / SLICE_MS);
+    if (slice_now < 0) slice_now = s;
+    long steps = s - slice_now;
+    if (steps > SLICES) steps = SLICES;
+    for (long i = 1; i <= steps; ++i) {
+        int slot = (int)((slice_now + i) % SLICES);
+        memset(sketch[slot], 0, sizeof(sketch[slot]));
+        for (int j = 0; j < HEAVY_SLOTS; ++j) heavy[j].counts[slot] = 0;
+    }
+    slice_now = s;
+}
+
+static int heavy_total(const HeavyHitter *hh) {
+    int n = 0;
+    for (int s = 0; s < SLICES; ++s) n += hh->counts[s];
+    return n;
+}
+
+static HeavyHitter *heavy_find(uint64_t h) {
+    for (int j = 0; j < HEAVY_SLOTS; ++j)
+        if (heavy[j].key == h) return &heavy[j];
+    return NULL;
+}
+
+static void bump(uint16_t *c) {
+    if (*c < UINT16_MAX) (*c)++;
+}
+
+/* Count-min estimate of the key's attempts in the window */
+static int sketch_estimate(uint64_t h) {
+    int best = -1;
+    for (int r = 0; r < SKETCH_ROWS; ++r) {
+        int n = 0;
+        for (int s = 0; s < SLICES; ++s) n += sketch[s][r][cell(h, r)];
+        if (best < 0 || n < best) best = n;
+    }
+    return best;
+}
+
+/* Take the key into the exact table, seeded per slice from the sketch.
+ * A full table gives up its smallest entry if the newcomer is bigger. */
+static HeavyHitter *heavy_admit(uint64_t h, RateKind kind, const char *key, int estimate) {
+    HeavyHitter *victim = NULL;
+    int victim_total = 0;
+    for (int j = 0; j < HEAVY_SLOTS; ++j) {
+        int t = heavy[j].key ? heavy_total(&heavy[j]) : -1;
+        if (!victim || t < victim_total) { victim = &heavy[j]; victim_total = t; }
+    }
+    if (victim->key && victim_total >= estimate) return NULL;
+    memset(victim, 0, sizeof(*victim));
+    victim->key = h;
+    victim->kind = kind;
+    snprintf(victim->label, sizeof(victim->label), "%s", key);
+    for (int s = 0; s < SLICES; ++s) {
+        int m = -1;
+        for (int r = 0; r < SKETCH_ROWS; ++r) {
+            int n = sketch[s][r][cell(h, r)];
+            if (m < 0 || n < m) m = n;
+        }
+        victim->counts[s] = (uint16_t)m;
+    }
+    return victim;
+}
+
+int rate_allow(RateKind kind, const char *key) {
+    if (!rate_limits_enabled || !key[0]) return 1;
+    advance();
+    uint64_t h = hash_key(kind, key);
+    int slot = (int)(slice_now % SLICES);
+    for (int r = 0; r < SKETCH_ROWS; ++r) bump(&sketch[slot][r][cell(h, r)]);
+
+    HeavyHitter *hh = heavy_find(h);
+    if (hh) {
+        bump(&hh->counts[slot]);
+    } else {
+        /* Keys well under the limit never leave the sketch */
+        int estimate = sketch_estimate(h);
+        if (estimate * 2 < limits[kind]) return 1;
+        hh = heavy_admit(h, kind, key, estimate);
+        if (!hh) return estimate <= limits[kind];
+    }
+    if (heavy_total(hh) <= limits[kind]) return 1;
+    hh->rejected++;
+    rejected_total[kind]++;
+    return 0;
+}
+
+const char *rate_session_key(void) {
+    static char session[32];
+    if (!session[0]) snprintf(session, sizeof(session), "pid%ld", (long)getpid());
+    return session;
+}
+
+void show_rate_limit_summary(void) {
+    long total = 0;
+    for (int k = 0; k < RATE_KINDS; ++k) total += rejected_total[k];
+    if (total == 0) return;
+    advance();
+    printf("\nRate limiting:\n");
+    for (int k = 0; k < RATE_KINDS; ++k) {
+        if (rejected_total[k]) printf("  %s: %ld attempt%s rejected (limit %d)\n", kind_names[k],
+                                      rejected_total[k], rejected_total[k] == 1 ? "" : "s", limits[k]);
+    }
+    for (int j = 0; j < HEAVY_SLOTS; ++j) {
+        if (!heavy[j].key || !heavy[j].rejected) continue;
+        printf("  Heavy hitter %s [%s]: %d attempts in the last %d s, %ld rejected\n", heavy[j].label,
+               kind_names[heavy[j].kind], heavy_total(&heavy[j]), RATE_WINDOW_SECONDS, heavy[j].rejected);
+    }
+}
@@ -0,0 +1,33 @@
+#ifndef RATELIMIT_H
+#define RATELIMIT_H
+
+/* Sliding-window limits on sign-in and booking attempts, per username,
+ * per phone and per client session. Attempts are counted in a count-min
+ * sketch, which takes fixed memory however many keys show up; a key whose
+ * estimate reaches half its limit moves into a small exact table of heavy
+ * hitters, and that table decides rejections. */
+
+#define RATE_WINDOW_SECONDS 60
+
+typedef enum {
+    RATE_SIGNIN_USER,
+    RATE_SIGNIN_SESSION,
+    RATE_BOOK_USER,
+    RATE_BOOK_PHONE,
+    RATE_BOOK_SESSION,
+    RATE_KINDS
+} RateKind;
+
+extern int rate_limits_enabled;
+
+/* Count one attempt by key. Returns 1 if it is within the limit for the
+ * last RATE_WINDOW_SECONDS, 0 if it must be rejected. */
+int rate_allow(RateKind kind, const char *key);
+
+/* Key of this client session, for the *_SESSION kinds */
+const char *rate_session_key(void);
+
+/* Heavy hitters and rejection counts, for the analytics report */
+void show_rate_limit_summary(void);
+
+#endif /* RATELIMIT_H */
@@ -0,0 +1,182 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "seatmap.h"
+#include "events.h"
+
+/* ============= CELL GEOMETRY ============= */
+
+static int label_width(const Section *sec) { return sec->rows > 26 ? 2 : 1; }
+static int num_width(const Section *sec) { return sec->cols > 99 ? 3 : 2; }
+static int cell_width(const Section *sec) { return label_width(sec) + num_width(sec) + 2; }
+
+/* Column-number line and every seat line have the same length */
+static size_t line_length(const Section *sec) {
+    return (size_t)(4 + label_width(sec)) + (size_t)sec->cols * (size_t)cell_width(sec) + 1;
+}
+
+static size_t cell_offset(const SeatMapCache *m, const Section *sec, int sidx, int row, int col) {
+    return m->section_at[sidx] + (size_t)(row + 1) * line_length(sec) +
+           (size_t)(4 + label_width(sec)) + (size_t)col * (size_t)cell_width(sec);
+}
+
+/* Right-justify n in width chars, space padded */
+static void put_number(char *p, int width, int n) {
+    for (int i = width - 1; i >= 0; --i) {
+        p[i] = (n > 0 || i == width - 1) ? (char)('0' + n % 10) : ' ';
+        n /= 10;
+    }
+}
+
+/* "[A 1]" when free, "[XXX]" when booked */
+static void put_cell(char *p, const Section *sec, int row, int col, int taken) {
+    int lw = label_width(sec), nw = num_width(sec);
+    p[0] = '[';
+    if (taken) {
+        memset(p + 1, 'X', (size_t)(lw + nw));
+    } else {
+        char rl[3];
+        format_row_label(row, rl);
+        size_t n = strlen(rl);
+        memcpy(p + 1, rl, n);
+        memset(p + 1 + n, ' ', (size_t)lw - n);
+        put_number(p + 1 + lw, nw, col + 1);
+    }
+    p[1 + lw + nw] = ']';
+}
+
+/* ============= BODY ============= */
+
+static void build_body(SeatMapCache *m, const VenueLayout *v, const SeatSnapshot *snap) {
+    size_t total = 0;
+    for (int s = 0; s < v->section_count; ++s) {
+        m->section_at[s] = total;
+        total += (size_t)(v->sections[s].rows + 1) * line_length(&v->sections[s]) + 1;
+    }
+    m->body.len = 0;
+    tb_reserve(&m->body, total + 1);
+
+    char *p = m->body.data;
+    for (int s = 0; s < v->section_count; ++s) {
+        const Section *sec = &v->sections[s];
+        int lw = label_width(sec), inner = lw + num_width(sec);
+        memset(p, ' ', (size_t)(4 + lw));
+        p += 4 + lw;
+        for (int c = 0; c < sec->cols; ++c) {
+            p[0] = ' ';
+            put_number(p + 1, inner, c + 1);
+            p[1 + inner] = ' ';
+            p += inner + 2;
+        }
+        *p++ = '\n';
+        for (int r = 0; r < sec->rows; ++r) {
+            char rl[3];
+            format_row_label(r, rl);
+            size_t n = strlen(rl);
+            p[0] = p[1] = ' ';
+            memcpy(p + 2, rl, n);
+            memset(p + 2 + n, ' ', (size_t)lw - n + 2);
+            p += 4 + lw;
+            for (int c = 0; c < sec->cols; ++c) {
+                SeatRef seat = { s, r, c };
+                put_cell(p, sec, r, c, seatsnap_taken(snap, v, seat));
+                p += inner + 2;
+            }
+            *p++ = '\n';
+        }
+        *p++ = '\n';
+    }
+    m->body.len = total;
+    m->body.data[total] = '\0';
+    memcpy(m->shown, snap->bits, sizeof(uint64_t) * (size_t)v->total_words);
+    m->body_valid = 1;
+}
+
+/* Redraw only the seats booked or released since the body was drawn */
+static void patch_body(SeatMapCache *m, const VenueLayout *v, const SeatSnapshot *snap) {
+    for (int s = 0; s < v->section_count; ++s) {
+        const Section *sec = &v->sections[s];
+        for (int r = 0; r < sec->rows; ++r) {
+            for (int w = 0; w < sec->words_per_row; ++w) {
+                size_t at = (size_t)sec->word_offset + (size_t)r * sec->words_per_row + w;
+                uint64_t diff = m->shown[at] ^ snap->bits[at];
+                while (diff) {
+                    int bit = __builtin_ctzll(diff);
+                    int c = w * 64 + bit;
+                    put_cell(m->body.data + cell_offset(m, sec, s, r, c), sec, r, c,
+                             (int)((snap->bits[at] >> bit) & 1u));
+                    diff &= diff - 1;
+                }
+                m->shown[at] = snap->bits[at];
+            }
+        }
+    }
+}
+
+/* ============= FULL TEXT ============= */
+
+static void build_text(SeatMapCache *m, const VenueLayout *v, const SeatSnapshot *snap, const char *title) {
+    TextBuf *tb = &m->text;
+    double occ = v->total_seats ? (snap->booked * 100.0) / v->total_seats : 0.0;
+    tb->len = 0;
+    tb_printf(tb, "\n+============================================================+\n");
+    tb_printf(tb, "|  Seat Map: %s\n", title);
+    tb_printf(tb, "|  Price: Rs.%.2f (%.0f%% full)\n", snap->base_price, occ);
+    tb_printf(tb, "+============================================================+\n");
+    tb_printf(tb, "\n");
+    for (int s = 0; s < v->section_count; ++s) {
+        const Section *sec = &v->sections[s];
+        if (v->section_count > 1) {
+            tb_printf(tb, "  Section %s (tier %d, x%.2f price) - %d/%d booked\n", sec->name, sec->tier,
+                      sec->price_factor, snap->section_booked[s], sec->rows * sec->cols);
+        }
+        size_t end = s + 1 < v->section_count ? m->section_at[s + 1] : m->body.len;
+        tb_append(tb, m->body.data + m->section_at[s], end - m->section_at[s]);
+    }
+    if (v->section_count > 1) {
+        tb_printf(tb, "  Legend: [XXX] = Booked  |  [A 1] = Available  |  Book as SECTION-A1\n");
+    } else {
+        tb_printf(tb, "  Legend: [XXX] = Booked  |  [A 1] = Available\n");
+    }
+    m->text_version = snap->version;
+}
+
+/* ============= PUBLIC API ============= */
+
+/* The event's seat map as of its latest published snapshot (the event
+ * must be materialized), built on first use and refreshed only as needed;
+ * title is the event name for the header */
+const TextBuf *seatmap_get(Event *e, const char *title) {
+    const VenueLayout *v = e->layout;
+    SeatMapCache *m = e->map;
+    if (!m) {
+        m = (SeatMapCache *)calloc(1, sizeof(SeatMapCache));
+        if (!m) { fprintf(stderr, "Memory allocation failed\n"); exit(1); }
+        m->section_at = (size_t *)malloc(sizeof(size_t) * (size_t)v->section_count);
+        m->shown = (uint64_t *)malloc(sizeof(uint64_t) * (size_t)v->total_words);
+        if (!m->section_at || !m->shown) { fprintf(stderr, "Memory allocation failed\n"); exit(1); }
+        tb_init(&m->body, 1024);
+        tb_init(&m->text, 1024);
+        e->map = m;
+    }
+    seatsnap_read_begin();
+    const SeatSnapshot *snap = seatsnap_get(e);
+    if (!m->body_valid) {
+        build_body(m, v, snap);
+        m->text_version = 0;
+    } else if (m->text_version != snap->version) {
+        patch_body(m, v, snap);
+    }
+    if (m->text_version != snap->version) build_text(m, v, snap, title);
+    seatsnap_read_end();
+    return &m->text;
+}
+
+void seatmap_free(SeatMapCache *m) {
+    if (!m) return;
+    tb_free(&m->body);
+    tb_free(&m->text);
+    free(m->section_at);
+    free(m->shown);
+    free(m);
+}
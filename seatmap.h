@@ -0,0 +1,28 @@
+#ifndef SEATMAP_H
+#define SEATMAP_H
+
+#include "venue.h"
+#include "utils.h"
+#include "seatsnap.h"
+
+struct Event;
+
+/* Rendered seat map of one event, drawn from its published seat snapshot.
+ * The body (column numbers and seat rows of every section) has fixed-width
+ * cells, so when a newer snapshot comes out only the seats whose bit
+ * differs from the copy kept here are patched in place. The full text adds
+ * the headers and is reassembled by copying once per snapshot. One thread
+ * at a time may use an event's cache. */
+typedef struct SeatMapCache {
+    TextBuf body;
+    size_t *section_at;   /* offset of each section's body */
+    uint64_t *shown;      /* occupancy bits the body shows */
+    int body_valid;
+    TextBuf text;         /* headers + body, ready to write */
+    unsigned long text_version;   /* snapshot the text shows, 0 = none */
+} SeatMapCache;
+
+void seatmap_free(SeatMapCache *m);
+const TextBuf *seatmap_get(struct Event *e, const char *title);
+
+#endif /* SEATMAP_H */
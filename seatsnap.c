@@ -0,0 +1,120 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "seatsnap.h"
+#include "events.h"
+#include "allocator.h"
+
+/* Readers record the epoch they started in; 0 marks a free slot */
+static unsigned long global_epoch = 1;
+static unsigned long reader_epoch[SEATSNAP_MAX_READERS];
+static __thread int reader_slot = -1;
+static __thread int reader_depth = 0;
+
+/* Replaced copies, oldest first; touched only by the writer */
+static SeatSnapshot *retired_head = NULL;
+static SeatSnapshot *retired_tail = NULL;
+
+/* ============= READERS ============= */
+
+void seatsnap_read_begin(void) {
+    if (reader_depth++ > 0) return;
+    unsigned long epoch = __atomic_load_n(&global_epoch, __ATOMIC_SEQ_CST);
+    /* There are more slots than threads that read, so a pass finds one */
+    for (int i = 0; ; i = (i + 1) % SEATSNAP_MAX_READERS) {
+        unsigned long expected = 0;
+        if (__atomic_compare_exchange_n(&reader_epoch[i], &expected, epoch, 0,
+                                        __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) {
+            reader_slot = i;
+            return;
+        }
+    }
+}
+
+void seatsnap_read_end(void) {
+    if (--reader_depth > 0) return;
+    __atomic_store_n(&reader_epoch[reader_slot], 0, __ATOMIC_RELEASE);
+    reader_slot = -1;
+}
+
+const SeatSnapshot *seatsnap_get(const Event *e) {
+    return __atomic_load_n(&e->snap, __ATOMIC_SEQ_CST);
+}
+
+int seatsnap_taken(const SeatSnapshot *s, const VenueLayout *v, SeatRef r) {
+    const Section *sec = &v->sections[r.section];
+    const uint64_t *w = s->bits + sec->word_offset + (size_t)r.row * sec->words_per_row;
+    return (int)((w[r.col >> 6] >> (r.col & 63)) & 1u);
+}
+
+/* ============= RECLAMATION ============= */
+
+/* A copy retired at epoch E was unpublished before the epoch moved past
+ * E, so only readers that started at E or earlier can still hold it */
+static void reclaim(void) {
+    unsigned long oldest = __atomic_load_n(&global_epoch, __ATOMIC_SEQ_CST);
+    for (int i = 0; i < SEATSNAP_MAX_READERS; ++i) {
+        unsigned long e = __atomic_load_n(&reader_epoch[i], __ATOMIC_SEQ_CST);
+        if (e && e < oldest) oldest = e;
+    }
+    while (retired_head && retired_head->retired_at < oldest) {
+        SeatSnapshot *s = retired_head;
+        retired_head = s->next_retired;
+        free(s);
+    }
+    if (!retired_head) retired_tail = NULL;
+}
+
+static void retire(SeatSnapshot *s) {
+    s->retired_at = __atomic_fetch_add(&global_epoch, 1, __ATOMIC_SEQ_CST);
+    s->next_retired = NULL;
+    if (retired_tail) retired_tail->next_retired = s;
+    else retired_head = s;
+    retired_tail = s;
+    reclaim();
+}
+
+/* ============= WRITER ============= */
+
+void seatsnap_publish(Event *e) {
+    if (!e->materialized) return;
+    const VenueLayout *v = e->layout;
+    size_t bits_len = sizeof(uint64_t) * (size_t)v->total_words;
+    /* One block: header, bitmap, per-section counts */
+    SeatSnapshot *s = (SeatSnapshot *)malloc(sizeof(SeatSnapshot) + bits_len + sizeof(int) * (size_t)v->section_count);
+    if (!s) { fprintf(stderr, "Memory allocation failed\n"); exit(1); }
+    s->bits = (uint64_t *)(s + 1);
+    s->section_booked = (int *)((char *)s->bits + bits_len);
+    memcpy(s->bits, e->occ.bits, bits_len);
+    memcpy(s->section_booked, e->occ.section_booked, sizeof(int) * (size_t)v->section_count);
+    s->booked = e->occ.booked;
+    s->base_price = e->base_price;
+    s->revenue = e->revenue;
+    s->total_bookings = e->total_bookings;
+    alloc_fragmentation(e->alloc, v, &e->occ, &s->orphans, &s->runs);
+
+    SeatSnapshot *old = e->snap;
+    s->version = old ? old->version + 1 : 1;
+    __atomic_store_n(&e->snap, s, __ATOMIC_SEQ_CST);
+    if (old) retire(old);
+}
+
+void seatsnap_publish_all(void) {
+    for (int i = 0; i < event_count; ++i) seatsnap_publish(&events[i]);
+}
+
+void seatsnap_drop(Event *e) {
+    SeatSnapshot *old = e->snap;
+    if (!old) return;
+    __atomic_store_n(&e->snap, NULL, __ATOMIC_SEQ_CST);
+    retire(old);
+}
+
+void seatsnap_cleanup(void) {
+    while (retired_head) {
+        SeatSnapshot *s = retired_head;
+        retired_head = s->next_retired;
+        free(s);
+    }
+    retired_tail = NULL;
+}
@@ -0,0 +1,51 @@
+#ifndef SEATSNAP_H
+#define SEATSNAP_H
+
+#include <stdint.h>
+#include "venue.h"
+
+struct Event;
+
+/* Read-only copies of an event's seats and counters for reports. The
+ * writer (the thread that books) changes the live bitmap freely and, once
+ * a change is complete, publishes a fresh copy with one atomic pointer
+ * store. Readers take whatever copy is published, without locks or
+ * waiting, and always see a state the writer finished. A replaced copy is
+ * freed only after every reader that could still hold it has left its
+ * read section (epoch-based reclamation). */
+
+#define SEATSNAP_MAX_READERS 128   /* threads inside a read section at once */
+
+typedef struct SeatSnapshot {
+    unsigned long version;   /* counts up with every publish for the event */
+    double base_price;
+    double revenue;
+    int total_bookings;
+    int booked;
+    int orphans;             /* fragmentation, from the allocation index */
+    int runs;
+    int *section_booked;
+    uint64_t *bits;          /* same shape as the event's occupancy bitmap */
+    struct SeatSnapshot *next_retired;
+    unsigned long retired_at;
+} SeatSnapshot;
+
+/* Writer side: publish the event's current state, replacing the old copy.
+ * Header-only events have no copy; readers use their counters directly. */
+void seatsnap_publish(struct Event *e);
+void seatsnap_publish_all(void);
+
+/* Unpublish before the event is freed */
+void seatsnap_drop(struct Event *e);
+
+/* Free every copy; call once no reader is left */
+void seatsnap_cleanup(void);
+
+/* Reader side. Sections nest; a snapshot stays valid until the outermost
+ * seatsnap_read_end(). */
+void seatsnap_read_begin(void);
+void seatsnap_read_end(void);
+const SeatSnapshot *seatsnap_get(const struct Event *e);   /* NULL if none */
+int seatsnap_taken(const SeatSnapshot *s, const VenueLayout *v, SeatRef r);
+
+#endif /* SEATSNAP_H */
@@ -0,0 +1,769 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include "shard.h"
+#include "events.h"
+#include "bookings.h"
+#include "bookid.h"
+#include "journal.h"
+#include "persist.h"
+#include "seatsnap.h"
+#include "columns.h"
+#include "ratelimit.h"
+#include "users.h"
+#include "venue.h"
+#include "utils.h"
+
+#define SHARD_SOCKET "shard.sock"
+#define SHARD_LAYOUT_FILE "shards.dat"
+#define SHARD_MAX_CLIENTS 16
+#define SHARD_LINE_MAX 1024
+
+int shard_count = 0;
+
+/* Fibonacci hashing spreads consecutive event numbers evenly */
+int shard_of_event(unsigned int event_no) {
+    return (int)((event_no * 2654435761u) % (unsigned int)shard_count);
+}
+
+static void shard_dir(int k, char *out, size_t n) {
+    snprintf(out, n, "shard-%d", k);
+}
+
+/* Split a request line in place on '|'; returns the field count */
+static int split_fields(char *line, char **f, int max) {
+    int n = 0;
+    f[n++] = line;
+    for (char *p = line; *p && n < max; ++p) {
+        if (*p != '|') continue;
+        *p = '\0';
+        f[n++] = p + 1;
+    }
+    return n;
+}
+
+static int write_all(int fd, const char *data, size_t len) {
+    while (len > 0) {
+        ssize_t w = write(fd, data, len);
+        if (w < 0 && errno == EINTR) continue;
+        if (w <= 0) return 0;
+        data += w;
+        len -= (size_t)w;
+    }
+    return 1;
+}
+
+/* ============= SHARD SERVER ============= */
+
+static volatile sig_atomic_t stop_requested = 0;
+
+static void on_stop_signal(int sig) {
+    (void)sig;
+    stop_requested = 1;
+}
+
+static void serve_list(TextBuf *out) {
+    for (int i = 0; i < event_count; ++i) {
+        const EventInfo *info = &event_info[i];
+        tb_printf(out, "EV|%u|%s|%s|%s|%.2f|%d|%d\n", info->event_no, info->name, info->event_date,
+                  info->event_time, events[i].base_price, get_seats_booked(i), get_total_seats(i));
+    }
+}
+
+/* BOOK|no|user|phone|email|seats|code */
+/* The customer named by a BOOK or WAIT request's user|phone|email fields */
+static void request_user(char **f, User *u) {
+    memset(u, 0, sizeof(*u));
+    snprintf(u->username, sizeof(u->username), "%s", f[2]);
+    snprintf(u->phone, sizeof(u->phone), "%s", f[3]);
+    snprintf(u->email, sizeof(u->email), "%s", f[4]);
+    u->role = ROLE_CUSTOMER;
+}
+
+static void serve_book(char **f, TextBuf *out) {
+    int idx = event_by_number((unsigned int)strtoul(f[1], NULL, 10));
+    User u;
+    request_user(f, &u);
+
+    char booking_id[32];
+    double total = 0.0;
+    const char *err = "no such event";
+    TextBuf labels;
+    tb_init(&labels, 64);
+    if (idx >= 0 && book_seats_direct(idx, &u, atoi(f[5]), f[6], booking_id, &labels, &total, &err)) {
+        tb_printf(out, "OK|%s|%.2f|%s\n", booking_id, total, labels.data);
+        printf("Booked %s for %s: %s\n", booking_id, u.username, labels.data);
+        persist_booking_change();
+    } else {
+        tb_printf(out, "ERR|%s\n", err);
+    }
+    tb_free(&labels);
+}
+
+/* CANCEL|booking id|user */
+static void serve_cancel(char **f, TextBuf *out) {
+    unsigned int shard, event_no;
+    uint64_t seq;
+    int cancelled = 0;
+    double refund = 0.0;
+    if (booking_id_decode(f[1], &shard, &seq, &event_no)) {
+        cancelled = cancel_booking_direct(event_by_number(event_no), f[1], f[2], &refund);
+    } else {
+        /* Older IDs don't name their event */
+        for (int e = 0; e < event_count && !cancelled; ++e)
+            cancelled = cancel_booking_direct(e, f[1], f[2], &refund);
+    }
+    if (!cancelled) { tb_printf(out, "ERR|booking not found\n"); return; }
+    if (cancelled < 0) { tb_printf(out, "ERR|cancellation could not be made durable\n"); return; }
+    tb_printf(out, "OK|%d|%.2f\n", cancelled, refund);
+    printf("Cancelled %d seat%s of %s for %s\n", cancelled, cancelled > 1 ? "s" : "", f[1], f[2]);
+    persist_booking_change();
+}
+
+/* WAIT|no|user|phone|email|seats */
+static void serve_wait(char **f, TextBuf *out) {
+    int idx = event_by_number((unsigned int)strtoul(f[1], NULL, 10));
+    User u;
+    request_user(f, &u);
+    if (idx < 0) tb_printf(out, "ERR|no such event\n");
+    else if (!join_waiting_direct(idx, &u, atoi(f[5]))) tb_printf(out, "ERR|queue for between 1 and 10 seats\n");
+    else tb_printf(out, "OK|%d\n", events[idx].wait_queue->size);
+}
+
+static void format_mine_line(const Booking *b, void *ctx) {
+    const EventInfo *info = &event_info[b->event_id];
+    char seat[MAX_SEAT_LABEL];
+    booking_seat_label(b, seat, sizeof(seat));
+    tb_printf((TextBuf *)ctx, "BK|%s|%s|%s|%s|%s|%.2f\n", b->booking_id, info->name,
+              info->event_date, info->event_time, seat, b->price_paid);
+}
+
+static void serve_mine(const char *username, TextBuf *out) {
+    visit_user_bookings(username, format_mine_line, out);
+}
+
+static void serve_map(const char *no, TextBuf *out) {
+    int idx = event_by_number((unsigned int)strtoul(no, NULL, 10));
+    if (idx < 0) { tb_printf(out, "ERR|no such event\n"); return; }
+    event_materialize(idx);
+    render_seat_map(idx, out);
+    if (out->len && out->data[out->len - 1] != '\n') tb_append(out, "\n", 1);
+}
+
+/* Answer one request line; returns 0 once asked to stop */
+static int serve_request(char *line, TextBuf *out) {
+    char *f[8];
+    int n = split_fields(line, f, 8);
+    int keep_going = 1;
+    if (strcmp(f[0], "LIST") == 0) serve_list(out);
+    else if (strcmp(f[0], "BOOK") == 0 && n == 7) serve_book(f, out);
+    else if (strcmp(f[0], "WAIT") == 0 && n == 6) serve_wait(f, out);
+    else if (strcmp(f[0], "CANCEL") == 0 && n == 3) serve_cancel(f, out);
+    else if (strcmp(f[0], "MINE") == 0 && n == 2) serve_mine(f[1], out);
+    else if (strcmp(f[0], "MAP") == 0 && n == 2) serve_map(f[1], out);
+    else if (strcmp(f[0], "QUIT") == 0) keep_going = 0;
+    else tb_printf(out, "ERR|bad request\n");
+    tb_append(out, ".\n", 2);
+    return keep_going;
+}
+
+typedef struct ShardClient {
+    int fd;
+    size_t len;
+    char buf[SHARD_LINE_MAX];
+} ShardClient;
+
+/* Read what the client sent and answer each complete line; returns 0 when
+ * the connection should be closed */
+static int serve_client(ShardClient *c) {
+    ssize_t r = read(c->fd, c->buf + c->len, sizeof(c->buf) - c->len);
+    if (r < 0 && errno == EINTR) return 1;
+    if (r <= 0) return 0;
+    c->len += (size_t)r;
+    char *nl;
+    while ((nl = memchr(c->buf, '\n', c->len)) != NULL) {
+        *nl = '\0';
+        TextBuf out;
+        tb_init(&out, 256);
+        if (!serve_request(c->buf, &out)) stop_requested = 1;
+        int ok = write_all(c->fd, out.data, out.len);
+        tb_free(&out);
+        size_t used = (size_t)(nl + 1 - c->buf);
+        memmove(c->buf, nl + 1, c->len - used);
+        c->len -= used;
+        if (!ok) return 0;
+    }
+    /* A line longer than any request */
+    return c->len < sizeof(c->buf);
+}
+
+static int listen_on_socket(const char *path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    unlink(path);
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(fd, SHARD_MAX_CLIENTS) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void serve_until_stopped(int lfd, pid_t router) {
+    ShardClient *clients = (ShardClient *)calloc(SHARD_MAX_CLIENTS, sizeof(ShardClient));
+    if (!clients) { fprintf(stderr, "Memory allocation failed\n"); exit(1); }
+    int nclients = 0;
+    struct pollfd pfd[1 + SHARD_MAX_CLIENTS];
+    /* A shard left behind by a router that died stops by itself */
+    while (!stop_requested && getppid() == router) {
+        pfd[0].fd = lfd;
+        pfd[0].events = nclients < SHARD_MAX_CLIENTS ? POLLIN : 0;
+        for (int i = 0; i < nclients; ++i) {
+            pfd[1 + i].fd = clients[i].fd;
+            pfd[1 + i].events = POLLIN;
+        }
+        int ready = poll(pfd, (nfds_t)(1 + nclients), 1000);
+        if (ready <= 0) continue;
+        for (int i = nclients - 1; i >= 0; --i) {
+            if (!(pfd[1 + i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+            if (serve_client(&clients[i])) continue;
+            close(clients[i].fd);
+            clients[i] = clients[--nclients];
+        }
+        if (pfd[0].revents & POLLIN) {
+            int fd = accept(lfd, NULL, NULL);
+            if (fd >= 0) {
+                clients[nclients].fd = fd;
+                clients[nclients].len = 0;
+                nclients++;
+            }
+        }
+    }
+    for (int i = 0; i < nclients; ++i) close(clients[i].fd);
+    free(clients);
+}
+
+/* Body of shard k's process: load its directory like a single-process
+ * start, serve until stopped, then save everything and exit */
+static void shard_server(int k, pid_t router) {
+    char dir[32];
+    shard_dir(k, dir, sizeof(dir));
+    if (chdir(dir) != 0) { fprintf(stderr, "Shard %d: cannot enter %s\n", k, dir); exit(1); }
+    if (!freopen("server.log", "a", stdout)) exit(1);
+    if (!freopen("/dev/null", "r", stdin)) exit(1);
+    setvbuf(stdout, NULL, _IOLBF, 0);
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_stop_signal;
+    sigaction(SIGTERM, &sa, NULL);
+    sigaction(SIGINT, &sa, NULL);
+
+    booking_shard = k;
+    load_venue_templates("venues.txt");
+    load_events_from_file("events.txt");
+    if (!open_bookings_snapshot("bookings.txt")) {
+        materialize_all_events();
+        load_bookings_from_file("bookings.txt");
+    }
+    if (booking_ids_load("ids.dat")) save_events_to_file("events.txt");
+    int replayed = replay_bookings_journal("bookings.journal");
+    seatsnap_publish_all();
+    columns_rebuild();
+
+    start_snapshot_writer();
+    if (!journal_open("bookings.journal")) {
+        printf("Warning: journal unavailable, saving full snapshots instead.\n");
+    } else if (replayed > 0 || journal_size() > 0) {
+        if (replayed > 0) printf("Recovered %d booking change%s from the journal.\n", replayed, replayed > 1 ? "s" : "");
+        checkpoint_bookings("bookings.txt");
+    }
+
+    int lfd = listen_on_socket(SHARD_SOCKET);
+    if (lfd < 0) { fprintf(stderr, "Shard %d: cannot listen on %s/%s\n", k, dir, SHARD_SOCKET); exit(1); }
+    printf("Shard %d serving %d event%s\n", k, event_count, event_count == 1 ? "" : "s");
+    serve_until_stopped(lfd, router);
+    close(lfd);
+    unlink(SHARD_SOCKET);
+
+    save_events_to_file("events.txt");
+    checkpoint_bookings("bookings.txt");
+    journal_close();
+    stop_snapshot_writer();
+    printf("Shard %d stopped\n", k);
+    columns_free();
+    close_bookings_snapshot();
+    cleanup_events_system();
+    cleanup_venue_templates();
+    exit(0);
+}
+
+/* ============= FIRST START: SPLITTING THE DATA ============= */
+
+/* Runs in a child holding all events: keep shard k's and write them out */
+static void write_shard_files(int k) {
+    unsigned char *drop = (unsigned char *)calloc((size_t)event_count + 1, 1);
+    if (!drop) { fprintf(stderr, "Memory allocation failed\n"); exit(1); }
+    for (int i = 0; i < event_count; ++i) drop[i] = (shard_of_event(event_info[i].event_no) != k);
+    remove_events(drop);
+    free(drop);
+
+    char dir[32];
+    shard_dir(k, dir, sizeof(dir));
+    if (chdir(dir) != 0) exit(1);
+    /* Carry the sequence on, so no shard repeats an ID issued before */
+    booking_ids_move("ids.dat");
+    save_venue_templates("venues.txt");
+    save_events_to_file("events.txt");
+    save_bookings_to_file("bookings.txt");
+    exit(wait_for_snapshots() ? 0 : 1);
+}
+
+static int split_into_shards(void) {
+    printf("Splitting data into %d shard%s...\n", shard_count, shard_count > 1 ? "s" : "");
+    load_venue_templates("venues.txt");
+    load_events_from_file("events.txt");
+    if (!open_bookings_snapshot("bookings.txt")) {
+        materialize_all_events();
+        load_bookings_from_file("bookings.txt");
+    }
+    if (booking_ids_load("ids.dat")) save_events_to_file("events.txt");
+    replay_bookings_journal("bookings.journal");
+    materialize_all_events();
+
+    int ok = 1;
+    for (int k = 0; k < shard_count && ok; ++k) {
+        char dir[32];
+        shard_dir(k, dir, sizeof(dir));
+        if (mkdir(dir, 0755) != 0 && errno != EEXIST) { printf("Cannot create %s.\n", dir); ok = 0; break; }
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid < 0) { ok = 0; break; }
+        if (pid == 0) write_shard_files(k);
+        int status = 0;
+        ok = waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        if (!ok) printf("Could not write the data for shard %d.\n", k);
+    }
+    close_bookings_snapshot();
+    cleanup_events_system();
+    cleanup_venue_templates();
+    if (!ok) return 0;
+
+    char buf[32];
+    int n = snprintf(buf, sizeof(buf), "SHARDS|%d\n", shard_count);
+    return write_file_atomic(SHARD_LAYOUT_FILE, buf, (size_t)n);
+}
+
+/* shards.dat: SHARDS|<count>. Events are placed by the count, so it
+ * can't change once the data is split. */
+static int prepare_shards(void) {
+    FILE *fp = fopen(SHARD_LAYOUT_FILE, "r");
+    if (!fp) return split_into_shards();
+    int n = 0;
+    int parsed = fscanf(fp, "SHARDS|%d", &n);
+    fclose(fp);
+    if (parsed != 1 || n != shard_count) {
+        printf("The data here is split across %d shard%s; start with --shards %d.\n", n, n == 1 ? "" : "s", n);
+        return 0;
+    }
+    for (int k = 0; k < shard_count; ++k) {
+        char path[64];
+        snprintf(path, sizeof(path), "shard-%d/events.txt", k);
+        if (access(path, F_OK) != 0) { printf("Shard data missing: %s\n", path); return 0; }
+    }
+    return 1;
+}
+
+/* ============= ROUTER ============= */
+
+static pid_t shard_pid[SHARD_MAX];
+static FILE *shard_rd[SHARD_MAX];
+static FILE *shard_wr[SHARD_MAX];
+
+static int connect_to_shard(int k) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "shard-%d/%s", k, SHARD_SOCKET);
+    /* The shard loads its data before it listens */
+    for (int attempt = 0; attempt < 300; ++attempt) {
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) return 0;
+        if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == 0) {
+            int wfd = dup(fd);
+            shard_rd[k] = fdopen(fd, "r");
+            shard_wr[k] = wfd >= 0 ? fdopen(wfd, "w") : NULL;
+            return shard_rd[k] && shard_wr[k];
+        }
+        close(fd);
+        int status;
+        if (waitpid(shard_pid[k], &status, WNOHANG) == shard_pid[k]) { shard_pid[k] = 0; return 0; }
+        struct timespec delay = { 0, 100 * 1000000L };
+        nanosleep(&delay, NULL);
+    }
+    return 0;
+}
+
+static void disconnect_shard(int k) {
+    if (shard_rd[k]) fclose(shard_rd[k]);
+    if (shard_wr[k]) fclose(shard_wr[k]);
+    shard_rd[k] = NULL;
+    shard_wr[k] = NULL;
+}
+
+/* Send one request to shard k and collect the reply lines before the
+ * closing "."; returns 0 if the shard can't be reached */
+static int shard_call(int k, const char *request, TextBuf *reply) {
+    if (!shard_rd[k]) { printf("Shard %d is unavailable.\n", k); return 0; }
+    if (fprintf(shard_wr[k], "%s\n", request) < 0 || fflush(shard_wr[k]) != 0) {
+        printf("Shard %d is not responding.\n", k);
+        disconnect_shard(k);
+        return 0;
+    }
+    char *line = NULL;
+    size_t cap = 0;
+    ssize_t len;
+    while ((len = getline(&line, &cap, shard_rd[k])) > 0) {
+        if (strcmp(line, ".\n") == 0) { free(line); return 1; }
+        tb_append(reply, line, (size_t)len);
+    }
+    free(line);
+    printf("Shard %d is not responding.\n", k);
+    disconnect_shard(k);
+    return 0;
+}
+
+static int start_shards(void) {
+    pid_t router = getpid();
+    for (int k = 0; k < shard_count; ++k) {
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid < 0) { printf("Could not start shard %d.\n", k); return 0; }
+        if (pid == 0) shard_server(k, router);
+        shard_pid[k] = pid;
+    }
+    for (int k = 0; k < shard_count; ++k) {
+        if (!connect_to_shard(k)) { printf("Shard %d did not start (see shard-%d/server.log).\n", k, k); return 0; }
+    }
+    return 1;
+}
+
+static void stop_shards(void) {
+    for (int k = 0; k < shard_count; ++k) {
+        if (!shard_pid[k]) continue;
+        TextBuf reply;
+        tb_init(&reply, 16);
+        int asked = shard_call(k, "QUIT", &reply);
+        tb_free(&reply);
+        disconnect_shard(k);
+        if (!asked) kill(shard_pid[k], SIGTERM);
+        waitpid(shard_pid[k], NULL, 0);
+        shard_pid[k] = 0;
+    }
+}
+
+/* Every event across the shards, in date order, as of the last listing */
+typedef struct ShardEvent {
+    unsigned int event_no;
+    char name[100];
+    char date[20];
+    char time[10];
+    double price;
+    int booked;
+    int total;
+} ShardEvent;
+
+static ShardEvent *catalog = NULL;
+static int catalog_count = 0;
+static int catalog_cap = 0;
+
+static int compare_shard_events(const void *a, const void *b) {
+    const ShardEvent *x = (const ShardEvent *)a, *y = (const ShardEvent *)b;
+    int c = strcmp(x->date, y->date);
+    if (c == 0) c = strcmp(x->time, y->time);
+    if (c == 0) c = strcmp(x->name, y->name);
+    return c;
+}
+
+static void add_catalog_line(char *line) {
+    char *f[8];
+    if (split_fields(line, f, 8) != 8 || strcmp(f[0], "EV") != 0) return;
+    if (catalog_count == catalog_cap) {
+        int cap = catalog_cap ? catalog_cap * 2 : 16;
+        ShardEvent *tmp = (ShardEvent *)realloc(catalog, sizeof(ShardEvent) * (size_t)cap);
+        if (!tmp) { fprintf(stderr, "Memory allocation failed\n"); exit(1); }
+        catalog = tmp;
+        catalog_cap = cap;
+    }
+    ShardEvent *e = &catalog[catalog_count++];
+    e->event_no = (unsigned int)strtoul(f[1], NULL, 10);
+    snprintf(e->name, sizeof(e->name), "%s", f[2]);
+    snprintf(e->date, sizeof(e->date), "%s", f[3]);
+    snprintf(e->time, sizeof(e->time), "%s", f[4]);
+    e->price = atof(f[5]);
+    e->booked = atoi(f[6]);
+    e->total = atoi(f[7]);
+}
+
+static void refresh_catalog(void) {
+    catalog_count = 0;
+    for (int k = 0; k < shard_count; ++k) {
+        TextBuf reply;
+        tb_init(&reply, 1024);
+        if (shard_call(k, "LIST", &reply) && reply.len) {
+            char *save = NULL;
+            for (char *line = strtok_r(reply.data, "\n", &save); line; line = strtok_r(NULL, "\n", &save))
+                add_catalog_line(line);
+        }
+        tb_free(&reply);
+    }
+    if (catalog_count > 1) qsort(catalog, (size_t)catalog_count, sizeof(ShardEvent), compare_shard_events);
+}
+
+static void list_catalog(void) {
+    refresh_catalog();
+    if (catalog_count == 0) {
+        printf("\nNo events available at the moment. Please check later.\n");
+        return;
+    }
+    printf("\nAvailable Events:\n");
+    for (int i = 0; i < catalog_count; ++i) {
+        const ShardEvent *e = &catalog[i];
+        double full = e->total ? 100.0 * e->booked / e->total : 0.0;
+        printf(" %d) %s - %s @ %s\n", i + 1, e->name, e->date, e->time);
+        printf("    Price: Rs.%.2f (%.0f%% full) | Seats: %d free of %d\n",
+               e->price, full, e->total - e->booked, e->total);
+    }
+}
+
+/* List the events and ask for one; NULL if none was chosen */
+static const ShardEvent *choose_event(const char *prompt) {
+    list_catalog();
+    if (catalog_count == 0) return NULL;
+    printf("%s", prompt);
+    int i = read_int() - 1;
+    if (i < 0 || i >= catalog_count) { printf("Invalid event.\n"); return NULL; }
+    return &catalog[i];
+}
+
+/* The owning shard keeps the queue and books from it as seats free up */
+static void routed_join_waiting(const User *user, unsigned int event_no, const char *name, int n) {
+    printf("Not enough seats available. Join waiting queue for %d seat%s? (y/n): ", n, n > 1 ? "s" : "");
+    char yn[8];
+    read_line(yn, sizeof(yn));
+    if (yn[0] != 'y' && yn[0] != 'Y') return;
+    char request[SHARD_LINE_MAX];
+    snprintf(request, sizeof(request), "WAIT|%u|%s|%s|%s|%d", event_no, user->username, user->phone, user->email, n);
+    TextBuf reply;
+    tb_init(&reply, 64);
+    if (shard_call(shard_of_event(event_no), request, &reply) && reply.len) {
+        char *f[2];
+        reply.data[strcspn(reply.data, "\n")] = '\0';
+        int nf = split_fields(reply.data, f, 2);
+        if (strcmp(f[0], "OK") == 0 && nf == 2)
+            printf("Added to waiting queue for %s (position %s). Seats freed by cancellations are booked for you.\n", name, f[1]);
+        else
+            printf("Could not join the waiting queue: %s\n", nf > 1 ? f[1] : "unexpected reply");
+    }
+    tb_free(&reply);
+}
+
+static void routed_book(const User *user) {
+    const ShardEvent *e = choose_event("Enter event number to book: ");
+    if (!e) return;
+    printf("How many seats do you want to book? (1-10): ");
+    int n = read_int();
+    if (n < 1 || n > 10) { printf("Invalid number of seats.\n"); return; }
+    if (!rate_allow(RATE_BOOK_USER, user->username) || !rate_allow(RATE_BOOK_PHONE, user->phone) ||
+        !rate_allow(RATE_BOOK_SESSION, rate_session_key())) {
+        printf("Too many booking attempts. Please wait a minute and try again.\n");
+        return;
+    }
+    char code[64];
+    printf("Enter discount code (or NA if none): ");
+    read_line(code, sizeof(code));
+    for (char *p = code; *p; ++p) if (*p == '|') *p = ' ';
+
+    char request[SHARD_LINE_MAX];
+    snprintf(request, sizeof(request), "BOOK|%u|%s|%s|%s|%d|%s",
+             e->event_no, user->username, user->phone, user->email, n, code);
+    char name[100];
+    snprintf(name, sizeof(name), "%s", e->name);
+    TextBuf reply;
+    tb_init(&reply, 256);
+    if (shard_call(shard_of_event(e->event_no), request, &reply) && reply.len) {
+        char *f[4];
+        reply.data[strcspn(reply.data, "\n")] = '\0';
+        int nf = split_fields(reply.data, f, 4);
+        if (strcmp(f[0], "OK") == 0 && nf == 4) {
+            printf("\nBooking successful!\n");
+            printf("  Booking ID: %s\n", f[1]);
+            printf("  Event: %s\n", name);
+            printf("  Seats: ");
+            char *save = NULL;
+            for (char *s = strtok_r(f[3], " ", &save); s; s = strtok_r(NULL, " ", &save)) printf("[%s] ", s);
+            printf("\n  Total Paid: Rs.%s\n", f[2]);
+        } else if (nf > 1 && strcmp(f[1], "not enough seats available") == 0) {
+            routed_join_waiting(user, e->event_no, name, n);
+        } else {
+            printf("Booking failed: %s\n", nf > 1 ? f[1] : "unexpected reply");
+        }
+    }
+    tb_free(&reply);
+}
+
+static void routed_cancel(const User *user) {
+    char booking_id[32];
+    printf("Enter Booking ID to cancel: ");
+    read_line(booking_id, sizeof(booking_id));
+    if (!booking_id[0] || strchr(booking_id, '|')) { printf("Invalid booking ID.\n"); return; }
+    char request[SHARD_LINE_MAX];
+    snprintf(request, sizeof(request), "CANCEL|%s|%s", booking_id, user->username);
+
+    /* Current IDs name their event, and so their shard; older ones are
+     * offered to each shard in turn */
+    unsigned int shard, event_no;
+    uint64_t seq;
+    int first = 0, last = shard_count - 1;
+    if (booking_id_decode(booking_id, &shard, &seq, &event_no)) first = last = shard_of_event(event_no);
+    for (int k = first; k <= last; ++k) {
+        TextBuf reply;
+        tb_init(&reply, 64);
+        int done = 0;
+        if (shard_call(k, request, &reply) && reply.len) {
+            char *f[3];
+            reply.data[strcspn(reply.data, "\n")] = '\0';
+            if (split_fields(reply.data, f, 3) == 3 && strcmp(f[0], "OK") == 0) {
+                int seats = atoi(f[1]);
+                printf("Cancelled %d seat%s of booking %s | Refund: Rs.%s\n", seats, seats > 1 ? "s" : "", booking_id, f[2]);
+                done = 1;
+            }
+        }
+        tb_free(&reply);
+        if (done) return;
+    }
+    printf("Booking ID '%s' not found.\n", booking_id);
+}
+
+static void routed_my_bookings(const User *user) {
+    printf("\n+============================================================+\n");
+    printf("|          MY BOOKINGS - %s\n", user->username);
+    printf("+============================================================+\n");
+    char request[SHARD_LINE_MAX];
+    snprintf(request, sizeof(request), "MINE|%s", user->username);
+    int shown = 0;
+    for (int k = 0; k < shard_count; ++k) {
+        TextBuf reply;
+        tb_init(&reply, 1024);
+        if (shard_call(k, request, &reply) && reply.len) {
+            char *save = NULL;
+            for (char *line = strtok_r(reply.data, "\n", &save); line; line = strtok_r(NULL, "\n", &save)) {
+                char *f[7];
+                if (split_fields(line, f, 7) != 7 || strcmp(f[0], "BK") != 0) continue;
+                printf("\n Booking ID: %s\n", f[1]);
+                printf("  Event: %s - %s @ %s\n", f[2], f[3], f[4]);
+                printf("  Seat: [%s]\n", f[5]);
+                printf("  Price Paid: Rs.%s\n", f[6]);
+                printf(" -------------------------------------------------------\n");
+                shown++;
+            }
+        }
+        tb_free(&reply);
+    }
+    if (shown == 0) printf("\n  (no bookings)\n");
+}
+
+static void routed_seat_map(void) {
+    const ShardEvent *e = choose_event("Enter event number to view: ");
+    if (!e) return;
+    char request[32];
+    snprintf(request, sizeof(request), "MAP|%u", e->event_no);
+    TextBuf reply;
+    tb_init(&reply, 4096);
+    if (shard_call(shard_of_event(e->event_no), request, &reply)) fwrite(reply.data, 1, reply.len, stdout);
+    tb_free(&reply);
+}
+
+static void routed_customer_portal(const User *user) {
+    while (1) {
+        print_divider();
+        printf("+============================================================+\n");
+        printf("|       CUSTOMER PORTAL - %s\n", user->username);
+        printf("+============================================================+\n");
+        printf("1) List events\n2) Book seats\n3) Cancel a booking (by ID)\n4) View my bookings\n5) Seat map\n6) Exit\nChoose: ");
+        int ch = read_int();
+        if (ch == 1) list_catalog();
+        else if (ch == 2) routed_book(user);
+        else if (ch == 3) routed_cancel(user);
+        else if (ch == 4) routed_my_bookings(user);
+        else if (ch == 5) routed_seat_map();
+        else if (ch == 6) { printf("Exiting customer portal.\n"); break; }
+        else { printf("Invalid option.\n"); continue; }
+        pause_enter();
+    }
+}
+
+int run_sharded(void) {
+    if (shard_count < 1 || shard_count > SHARD_MAX) {
+        fprintf(stderr, "--shards takes a count from 1 to %d\n", SHARD_MAX);
+        return 1;
+    }
+    /* A shard that went away must not take the router with it */
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = SIG_IGN;
+    sigaction(SIGPIPE, &sa, NULL);
+
+    if (!prepare_shards()) return 1;
+    if (!start_shards()) { stop_shards(); return 1; }
+    load_users_from_file("users.txt");
+
+    printf("Welcome to Concert Booking System (%d shard%s)\n", shard_count, shard_count > 1 ? "s" : "");
+    print_divider();
+    while (1) {
+        printf("\nMain Menu:\n1) Customer Portal\n2) Admin Portal\n3) Exit\nChoose: ");
+        int main_choice = read_int();
+        if (main_choice == 1) {
+            printf("\nCustomer Portal:\n1) Sign Up\n2) Sign In\nChoose: ");
+            int cs = read_int();
+            int idx;
+            if (cs == 1) {
+                if (signup_customer() >= 0) {
+                    printf("Sign in now? (y/n): ");
+                    char yn[8]; read_line(yn, sizeof(yn));
+                    if ((yn[0] == 'y' || yn[0] == 'Y') && signin_customer(&idx)) routed_customer_portal(&users[idx]);
+                }
+            } else if (cs == 2) {
+                if (signin_customer(&idx)) routed_customer_portal(&users[idx]);
+            } else {
+                printf("Invalid choice.\n");
+            }
+        } else if (main_choice == 2) {
+            /* Admin tasks need every event in one process */
+            printf("The admin portal isn't available while the events are sharded.\n");
+        } else if (main_choice == 3) {
+            printf("Exiting program. Goodbye.\n");
+            save_users_to_file("users.txt");
+            break;
+        } else {
+            printf("Invalid option.\n");
+        }
+    }
+    stop_shards();
+    free(catalog);
+    free(users);
+    return 0;
+}
@@ -0,0 +1,36 @@
+#ifndef SHARD_H
+#define SHARD_H
+
+/* Sharded deployment. With --shards N the events are split across N
+ * server processes by a hash of their event number; each owns its events'
+ * seats, bookings, journal and snapshots in shard-K/ and serves requests
+ * on the Unix socket shard-K/shard.sock. The process started by the user
+ * becomes the router: it keeps the user directory (users.txt), signs
+ * customers in, and sends each request to the shard that owns the event.
+ * A booking ID names its event, so cancels go straight to one shard.
+ *
+ * The first sharded start splits the single-process data files into the
+ * shard directories and records the shard count in shards.dat; later
+ * starts must use the same count.
+ *
+ * Requests and replies are '|'-separated lines; every reply ends with a
+ * line holding only ".":
+ *   LIST                                  -> EV|no|name|date|time|price|booked|total
+ *   BOOK|no|user|phone|email|seats|code   -> OK|booking id|total|seat labels, or ERR|reason
+ *   WAIT|no|user|phone|email|seats        -> OK|queue length, or ERR|reason
+ *   CANCEL|booking id|user                -> OK|seats|refund, or ERR|reason
+ *   MINE|user                             -> BK|booking id|name|date|time|seat|price
+ *   MAP|no                                -> the seat map text
+ *   QUIT                                  -> saves and stops the shard */
+
+#define SHARD_MAX 16   /* one per value of a booking ID's shard bits */
+
+extern int shard_count;   /* 0 = single process */
+
+int shard_of_event(unsigned int event_no);
+
+/* Start the shards and run the customer menu as the router; returns the
+ * process exit status */
+int run_sharded(void);
+
+#endif /* SHARD_H */
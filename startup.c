@@ -0,0 +1,175 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "startup.h"
+#include "workers.h"
+#include "users.h"
+#include "events.h"
+#include "bookings.h"
+#include "utils.h"
+
+/* Chunks per worker thread; a few extra keeps threads busy when line lengths vary */
+#define CHUNKS_PER_WORKER 4
+
+typedef struct FileBuffer {
+    const char *path;
+    char *data;
+    size_t len;
+} FileBuffer;
+
+/* Per-chunk parse output: one reversed booking list per event */
+typedef struct ChunkResult {
+    char *start;
+    char *end;
+    Booking **heads;
+    Booking **tails;
+    int parsed;
+    int rejected;
+} ChunkResult;
+
+typedef struct BookingLoad {
+    ChunkResult *chunks;
+    int chunk_count;
+} BookingLoad;
+
+static void *load_users_thread(void *p) {
+    load_users_from_file((const char *)p);
+    return NULL;
+}
+
+static void *read_file_thread(void *p) {
+    FileBuffer *fb = (FileBuffer *)p;
+    fb->data = NULL;
+    fb->len = 0;
+    FILE *fp = fopen(fb->path, "rb");
+    if (!fp) return NULL;
+    if (fseek(fp, 0, SEEK_END) == 0) {
+        long sz = ftell(fp);
+        if (sz > 0 && fseek(fp, 0, SEEK_SET) == 0) {
+            fb->data = (char *)malloc((size_t)sz + 1);
+            if (fb->data) {
+                fb->len = fread(fb->data, 1, (size_t)sz, fp);
+                fb->data[fb->len] = '\0';
+            }
+        }
+    }
+    fclose(fp);
+    return NULL;
+}
+
+/* Parse every line in [start, end) into per-event lists for this chunk */
+static void parse_chunk(int c, void *ctx) {
+    BookingLoad *ld = (BookingLoad *)ctx;
+    ChunkResult *cr = &ld->chunks[c];
+    char *p = cr->start;
+    while (p < cr->end) {
+        char *nl = memchr(p, '\n', (size_t)(cr->end - p));
+        char *line_end = nl ? nl : cr->end;
+        *line_end = '\0';
+        if (line_end > p && *p != '#') {   /* '#': snapshot trailer */
+            Booking *b = (Booking *)malloc(sizeof(Booking));
+            if (b && parse_booking_record(p, b)) {
+                b->next = cr->heads[b->event_id];
+                cr->heads[b->event_id] = b;
+                if (!cr->tails[b->event_id]) cr->tails[b->event_id] = b;
+                cr->parsed++;
+            } else {
+                free(b);
+                cr->rejected++;
+            }
+        }
+        p = line_end + 1;
+    }
+}
+
+/* Splice each chunk's list for one event in file order and rebuild its stats.
+ * The resulting list order matches load_bookings_from_file(). */
+static void merge_event(int e, void *ctx) {
+    BookingLoad *ld = (BookingLoad *)ctx;
+    Event *ev = &events[e];
+    for (int c = 0; c < ld->chunk_count; ++c) {
+        ChunkResult *cr = &ld->chunks[c];
+        if (!cr->heads[e]) continue;
+        cr->tails[e]->next = ev->bookings_head;
+        ev->bookings_head = cr->heads[e];
+    }
+    for (Booking *b = ev->bookings_head; b; b = b->next) apply_loaded_booking(b);
+}
+
+void parallel_startup_load(const char *events_path, const char *bookings_path, const char *users_path) {
+    double t0 = now_ms();
+
+    /* Phase 1: users, events and the raw bookings file in parallel */
+    FileBuffer fb;
+    fb.path = bookings_path;
+    pthread_t users_tid, read_tid;
+    int users_async = (pthread_create(&users_tid, NULL, load_users_thread, (void *)users_path) == 0);
+    int read_async = (pthread_create(&read_tid, NULL, read_file_thread, &fb) == 0);
+    if (!users_async) load_users_from_file(users_path);
+    load_events_from_file(events_path);
+    if (!read_async) read_file_thread(&fb);
+    if (users_async) pthread_join(users_tid, NULL);
+    if (read_async) pthread_join(read_tid, NULL);
+    materialize_all_events();   /* full load: every event gets its seats up front */
+    double t1 = now_ms();
+    printf("[startup] users + events + bookings read: %.1f ms (%d users, %d events, %lu bytes)\n",
+           t1 - t0, user_count, event_count, (unsigned long)fb.len);
+
+    if (!fb.data || event_count == 0) {
+        free(fb.data);
+        printf("[startup] total: %.1f ms\n", now_ms() - t0);
+        return;
+    }
+
+    /* Phase 2: split at line boundaries and parse chunks in parallel */
+    int chunk_count = worker_threads * CHUNKS_PER_WORKER;
+    size_t min_chunk = 64 * 1024;
+    if ((size_t)chunk_count > fb.len / min_chunk + 1) chunk_count = (int)(fb.len / min_chunk) + 1;
+
+    BookingLoad ld;
+    ld.chunks = (ChunkResult *)calloc((size_t)chunk_count, sizeof(ChunkResult));
+    if (!ld.chunks) { fprintf(stderr, "Startup allocation failed\n"); exit(1); }
+    char *cursor = fb.data;
+    char *file_end = fb.data + fb.len;
+    int used = 0;
+    for (int c = 0; c < chunk_count && cursor < file_end; ++c) {
+        char *end = (c == chunk_count - 1) ? file_end : cursor + fb.len / (size_t)chunk_count;
+        if (end > file_end) end = file_end;
+        if (end < file_end) {
+            char *nl = memchr(end, '\n', (size_t)(file_end - end));
+            end = nl ? nl + 1 : file_end;
+        }
+        ChunkResult *cr = &ld.chunks[used++];
+        cr->start = cursor;
+        cr->end = end;
+        cr->heads = (Booking **)calloc((size_t)event_count, sizeof(Booking *));
+        cr->tails = (Booking **)calloc((size_t)event_count, sizeof(Booking *));
+        if (!cr->heads || !cr->tails) { fprintf(stderr, "Startup allocation failed\n"); exit(1); }
+        cursor = end;
+    }
+    ld.chunk_count = used;
+
+    parallel_for(ld.chunk_count, parse_chunk, &ld);
+    double t2 = now_ms();
+    int parsed = 0, rejected = 0;
+    for (int c = 0; c < ld.chunk_count; ++c) {
+        parsed += ld.chunks[c].parsed;
+        rejected += ld.chunks[c].rejected;
+    }
+    printf("[startup] bookings parse: %.1f ms (%d records, %d skipped, %d chunks, %d threads)\n",
+           t2 - t1, parsed, rejected, ld.chunk_count, worker_threads);
+
+    /* Phase 3: merge per event, also in parallel since events are disjoint */
+    parallel_for(event_count, merge_event, &ld);
+    double t3 = now_ms();
+    printf("[startup] bookings merge: %.1f ms\n", t3 - t2);
+
+    for (int c = 0; c < ld.chunk_count; ++c) {
+        free(ld.chunks[c].heads);
+        free(ld.chunks[c].tails);
+    }
+    free(ld.chunks);
+    free(fb.data);
+    printf("[startup] total: %.1f ms\n", t3 - t0);
+}
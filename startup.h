@@ -0,0 +1,9 @@
+#ifndef STARTUP_H
+#define STARTUP_H
+
+/* Parallel startup: users and events are loaded concurrently, then the
+ * bookings file is split into chunks parsed by worker_threads threads and
+ * merged into per-event lists. Phase timings are logged to stdout. */
+void parallel_startup_load(const char *events_path, const char *bookings_path, const char *users_path);
+
+#endif /* STARTUP_H */
@@ -0,0 +1,172 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "txn.h"
+#include "journal.h"
+#include "columns.h"
+#include "purchase.h"
+#include "utils.h"
+#include "seatsnap.h"
+
+void txn_begin(Txn *t) {
+    t->ops = NULL;
+    t->count = 0;
+    t->cap = 0;
+}
+
+static TxnOp *push_op(Txn *t) {
+    if (t->count == t->cap) {
+        int cap = t->cap ? t->cap * 2 : 8;
+        TxnOp *tmp = (TxnOp *)realloc(t->ops, sizeof(TxnOp) * (size_t)cap);
+        if (!tmp) { fprintf(stderr, "Memory allocation failed\n"); exit(1); }
+        t->ops = tmp;
+        t->cap = cap;
+    }
+    return &t->ops[t->count++];
+}
+
+/* Readers see each touched event once, after the whole change */
+static void publish_touched(const Txn *t) {
+    for (int i = 0; i < t->count; ++i) {
+        int ev = t->ops[i].event_idx;
+        int seen = 0;
+        for (int j = 0; j < i && !seen; ++j) seen = (t->ops[j].event_idx == ev);
+        if (!seen) seatsnap_publish(&events[ev]);
+    }
+}
+
+static void txn_reset(Txn *t) {
+    free(t->ops);
+    txn_begin(t);
+}
+
+/* ============= STAGING ============= */
+
+int txn_book(Txn *t, const Booking *tmpl, const SeatRef *seats, const double *prices, int n) {
+    if (n < 1) return 0;
+    Event *ev = &events[tmpl->event_id];
+    for (int i = 0; i < n; ++i) if (event_seat_taken(ev, seats[i])) return 0;
+
+    Booking **staged = (Booking **)calloc((size_t)n, sizeof(Booking *));
+    if (!staged) return 0;
+    for (int i = 0; i < n; ++i) {
+        staged[i] = (Booking *)malloc(sizeof(Booking));
+        if (!staged[i]) {
+            for (int j = 0; j < i; ++j) free(staged[j]);
+            free(staged);
+            return 0;
+        }
+        *staged[i] = *tmpl;
+        staged[i]->section = seats[i].section;
+        staged[i]->row = seats[i].row;
+        staged[i]->col = seats[i].col;
+        staged[i]->price_paid = prices[i];
+        if (!tmpl->num_seats) staged[i]->num_seats = n;
+        staged[i]->col_slot = -1;
+        staged[i]->next = NULL;
+    }
+    /* Hold the seats only once nothing else can fail */
+    for (int i = 0; i < n; ++i) {
+        event_mark_seat(ev, seats[i]);
+        TxnOp *op = push_op(t);
+        op->kind = TXN_BOOK;
+        op->event_idx = tmpl->event_id;
+        op->booking = staged[i];
+        op->refund = 0;
+        op->group_start = (i == 0 && !tmpl->num_seats);
+    }
+    free(staged);
+    return 1;
+}
+
+int txn_cancel(Txn *t, Booking *b, double refund) {
+    for (int i = 0; i < t->count; ++i)
+        if (t->ops[i].kind == TXN_CANCEL && t->ops[i].booking == b) return 0;
+    TxnOp *op = push_op(t);
+    op->kind = TXN_CANCEL;
+    op->event_idx = b->event_id;
+    op->booking = b;
+    op->refund = refund;
+    op->group_start = 0;
+    return 1;
+}
+
+/* ============= COMMIT ============= */
+
+/* Journal record types: "A|<booking record>" adds a seat booking,
+ * "X|event_id|row|col|booking_id|section" removes one. A transaction of
+ * more than one change is framed as "T|<count>" followed by its records. */
+static void journal_booking_added(TextBuf *tb, const Booking *b) {
+    tb_append(tb, "A|", 2);
+    format_booking_record(tb, b);
+}
+
+static void journal_booking_removed(TextBuf *tb, const Booking *b) {
+    tb_printf(tb, "X|%d|%d|%d|%s|%d\n", b->event_id, b->row, b->col, b->booking_id, b->section);
+}
+
+static void unlink_booking(Event *ev, Booking *b) {
+    Booking **pp = &ev->bookings_head;
+    while (*pp && *pp != b) pp = &(*pp)->next;
+    if (*pp) *pp = b->next;
+}
+
+int txn_commit(Txn *t) {
+    if (t->count == 0) { txn_reset(t); return 1; }
+    TextBuf rec;
+    tb_init(&rec, 256 * (size_t)t->count);
+    if (t->count > 1) tb_printf(&rec, "T|%d\n", t->count);
+    for (int i = 0; i < t->count; ++i) {
+        if (t->ops[i].kind == TXN_BOOK) journal_booking_added(&rec, t->ops[i].booking);
+        else journal_booking_removed(&rec, t->ops[i].booking);
+    }
+    /* Journal first, while the staged seats are still held: the change
+     * is applied only once it is durable, and a failed write leaves
+     * nothing behind. Concurrent commits share the journal's group fsync. */
+    int durable = !journal_is_open() || journal_commit(rec.data, rec.len);
+    tb_free(&rec);
+    if (!durable) {
+        printf("Warning: change could not be written to the journal.\n");
+        txn_rollback(t);
+        return 0;
+    }
+
+    for (int i = 0; i < t->count; ++i) {
+        TxnOp *op = &t->ops[i];
+        Booking *b = op->booking;
+        Event *ev = &events[b->event_id];
+        if (op->kind == TXN_BOOK) {
+            /* The seat was marked when the booking was staged */
+            b->next = ev->bookings_head;
+            ev->bookings_head = b;
+            columns_add(b);
+            ev->revenue += b->price_paid;
+            if (op->group_start) ev->total_bookings++;
+            purchase_count(b->event_id, b->username, b->phone, 1);
+        } else {
+            SeatRef seat = { b->section, b->row, b->col };
+            unlink_booking(ev, b);
+            purchase_count(b->event_id, b->username, b->phone, -1);
+            columns_remove(b);
+            event_release_seat(ev, seat);
+            ev->revenue -= op->refund;
+            free(b);
+        }
+    }
+    publish_touched(t);
+    txn_reset(t);
+    return 1;
+}
+
+void txn_rollback(Txn *t) {
+    for (int i = 0; i < t->count; ++i) {
+        TxnOp *op = &t->ops[i];
+        if (op->kind != TXN_BOOK) continue;
+        Booking *b = op->booking;
+        SeatRef seat = { b->section, b->row, b->col };
+        event_release_seat(&events[b->event_id], seat);
+        free(b);
+    }
+    publish_touched(t);
+    txn_reset(t);
+}
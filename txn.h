@@ -0,0 +1,51 @@
+#ifndef TXN_H
+#define TXN_H
+
+#include "bookings.h"
+
+/* Booking transactions. Changes are staged first: a staged booking holds
+ * its seats at once (so no one else can take them) and allocates
+ * everything it will need, and a staged cancellation only notes the
+ * booking. Commit then applies every change with nothing left that can
+ * fail and journals them as one record, which replay applies whole or
+ * not at all. Rollback frees the staged bookings and releases their seats.
+ * A transaction may span events. */
+
+#define TXN_BOOK 1
+#define TXN_CANCEL 2
+
+typedef struct TxnOp {
+    int kind;
+    int event_idx;
+    Booking *booking;   /* staged new booking, or the booking to cancel */
+    double refund;      /* cancel: taken off the event's revenue */
+    int group_start;    /* book: first seat of a booking, counted once */
+} TxnOp;
+
+typedef struct Txn {
+    TxnOp *ops;
+    int count;
+    int cap;
+} Txn;
+
+void txn_begin(Txn *t);
+
+/* Stage one booking of n seats; tmpl gives the event, customer, booking
+ * ID and timestamp, prices[i] the price of seats[i]. A nonzero
+ * tmpl->num_seats adds the seats to that existing booking instead (as
+ * when a seat is swapped). Returns 0 if a seat is taken or memory runs
+ * out; nothing is staged then. */
+int txn_book(Txn *t, const Booking *tmpl, const SeatRef *seats, const double *prices, int n);
+
+/* Stage the cancellation of b, refunding refund. Returns 0 if b is
+ * already being cancelled by this transaction. */
+int txn_cancel(Txn *t, Booking *b, double refund);
+
+/* Journal everything staged, waiting until it is durable, then apply it.
+ * Returns 0 if the journal write failed; the transaction is rolled back
+ * then, so nothing changes. The transaction is empty afterwards. */
+int txn_commit(Txn *t);
+
+void txn_rollback(Txn *t);
+
+#endif /* TXN_H */
@@ -4,6 +4,8 @@
 #include <ctype.h>
 #include "users.h"
 #include "utils.h"
+#include "persist.h"
+#include "ratelimit.h"
 
 #define INITIAL_USER_CAP 128
 
@@ -243,6 +245,10 @@ int signin_customer(int *out_idx) {
     read_line(username, sizeof(username));
     printf("Password: ");
     read_line(password, sizeof(password));
+    if (!rate_allow(RATE_SIGNIN_USER, username) || !rate_allow(RATE_SIGNIN_SESSION, rate_session_key())) {
+        printf("Too many sign-in attempts. Please wait a minute and try again.\n");
+        return 0;
+    }
     int idx = find_user_index(username);
     if (idx == -1) { printf("No such user.\n"); return 0; }
     if (users[idx].role != ROLE_CUSTOMER) { printf("Not a customer account.\n"); return 0; }
@@ -301,6 +307,10 @@ int signin_admin(int *out_idx) {
     read_line(username, sizeof(username));
     printf("Password: ");
     read_line(password, sizeof(password));
+    if (!rate_allow(RATE_SIGNIN_USER, username) || !rate_allow(RATE_SIGNIN_SESSION, rate_session_key())) {
+        printf("Too many sign-in attempts. Please wait a minute and try again.\n");
+        return 0;
+    }
     int idx = find_user_index(username);
     if (idx == -1) { printf("No such user.\n"); return 0; }
     if (users[idx].role != ROLE_ADMIN) { printf("Not an admin account.\n"); return 0; }
@@ -313,22 +323,20 @@ int signin_admin(int *out_idx) {
 /* ============= USER PERSISTENCE ============= */
 
 void save_users_to_file(const char *path) {
-    FILE *fp = fopen(path, "w");
-    if (!fp) { 
-        printf("Warning: Failed to save users to %s\n", path); 
-        return; 
-    }
+    /* Serialize on this thread; the snapshot writer does the file I/O */
+    TextBuf tb;
+    tb_init(&tb, (size_t)user_count * 128);
     
     for (int i = 0; i < user_count; ++i) {
         User *u = &users[i];
         const char *role_str = (u->role == ROLE_ADMIN) ? "ADMIN" : 
                                (u->role == ROLE_CUSTOMER) ? "CUSTOMER" : "NONE";
         /* Format: username|password|role|phone|email */
-        fprintf(fp, "%s|%s|%s|%s|%s\n", 
+        tb_printf(&tb, "%s|%s|%s|%s|%s\n", 
                 u->username, u->password, role_str, u->phone, u->email);
     }
     
-    fclose(fp);
+    submit_snapshot(path, &tb);
 }
 
 void load_users_from_file(const char *path) {
@@ -349,30 +357,31 @@ void load_users_from_file(const char *path) {
         char phone[MAX_PHONE], email[MAX_EMAIL];
         
         /* Parse: username|password|role|phone|email */
+        /* Reentrant: users load on their own thread during parallel startup */
         char *tok;
-        char *rest = line;
+        char *save = NULL;
         
-        tok = strtok(rest, "|"); 
+        tok = strtok_r(line, "|", &save); 
         if (!tok) continue; 
         strncpy(username, tok, sizeof(username)-1); 
         username[sizeof(username)-1] = '\0';
         
-        tok = strtok(NULL, "|"); 
+        tok = strtok_r(NULL, "|", &save); 
         if (!tok) continue; 
         strncpy(password, tok, sizeof(password)-1); 
         password[sizeof(password)-1] = '\0';
         
-        tok = strtok(NULL, "|"); 
+        tok = strtok_r(NULL, "|", &save); 
         if (!tok) continue; 
         strncpy(role_str, tok, sizeof(role_str)-1); 
         role_str[sizeof(role_str)-1] = '\0';
         
-        tok = strtok(NULL, "|"); 
+        tok = strtok_r(NULL, "|", &save); 
         if (!tok) continue; 
         strncpy(phone, tok, sizeof(phone)-1); 
         phone[sizeof(phone)-1] = '\0';
         
-        tok = strtok(NULL, "|"); 
+        tok = strtok_r(NULL, "|", &save); 
         if (!tok) continue; 
         strncpy(email, tok, sizeof(email)-1); 
         email[sizeof(email)-1] = '\0';
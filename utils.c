@@ -1,6 +1,8 @@
 #include "utils.h"
 #include <string.h>
 #include <stdlib.h>  
+#include <time.h>
+#include <stdarg.h>
 
 void read_line(char *buf, int n) {
     if (!fgets(buf, n, stdin)) {
@@ -24,4 +26,60 @@ void pause_enter(void) {
     printf("Press Enter to continue...");
     char tmp[4];
     read_line(tmp, sizeof(tmp));
-}
\ No newline at end of file
+}
+
+/* Monotonic clock in milliseconds, for timing phases */
+double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+/* ============= TEXT BUFFER ============= */
+
+void tb_init(TextBuf *tb, size_t initial_cap) {
+    if (initial_cap < 64) initial_cap = 64;
+    tb->data = (char *)malloc(initial_cap);
+    if (!tb->data) { fprintf(stderr, "Buffer allocation failed\n"); exit(1); }
+    tb->data[0] = '\0';
+    tb->len = 0;
+    tb->cap = initial_cap;
+}
+
+void tb_reserve(TextBuf *tb, size_t extra) {
+    if (tb->len + extra + 1 <= tb->cap) return;
+    size_t cap = tb->cap * 2;
+    while (cap < tb->len + extra + 1) cap *= 2;
+    char *tmp = (char *)realloc(tb->data, cap);
+    if (!tmp) { fprintf(stderr, "Buffer allocation failed\n"); exit(1); }
+    tb->data = tmp;
+    tb->cap = cap;
+}
+
+void tb_append(TextBuf *tb, const char *s, size_t n) {
+    tb_reserve(tb, n);
+    memcpy(tb->data + tb->len, s, n);
+    tb->len += n;
+    tb->data[tb->len] = '\0';
+}
+
+void tb_printf(TextBuf *tb, const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(tb->data + tb->len, tb->cap - tb->len, fmt, ap);
+    va_end(ap);
+    if (n < 0) return;
+    if ((size_t)n >= tb->cap - tb->len) {
+        tb_reserve(tb, (size_t)n);
+        va_start(ap, fmt);
+        vsnprintf(tb->data + tb->len, tb->cap - tb->len, fmt, ap);
+        va_end(ap);
+    }
+    tb->len += (size_t)n;
+}
+
+void tb_free(TextBuf *tb) {
+    free(tb->data);
+    tb->data = NULL;
+    tb->len = tb->cap = 0;
+}
@@ -2,10 +2,25 @@
 #define UTILS_H
 
 #include <stdio.h>
+#include <stddef.h>
+
+/* Growable text buffer used to build file snapshots and reports in memory */
+typedef struct TextBuf {
+    char *data;
+    size_t len;
+    size_t cap;
+} TextBuf;
 
 void read_line(char *buf, int n);
 int read_int(void);
 void print_divider(void);
 void pause_enter(void);
+double now_ms(void);
+
+void tb_init(TextBuf *tb, size_t initial_cap);
+void tb_reserve(TextBuf *tb, size_t extra);
+void tb_append(TextBuf *tb, const char *s, size_t n);
+void tb_printf(TextBuf *tb, const char *fmt, ...);
+void tb_free(TextBuf *tb);
 
 #endif /* UTILS_H */
\ No newline at end of file
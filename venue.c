@@ -0,0 +1,555 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include "venue.h"
+#include "persist.h"
+
+static int parse_row_and_seat(const char *text, int *row, int *col);
+
+/* ============= LAYOUTS ============= */
+
+typedef struct ScoredSeat {
+    int score;
+    int seat;
+} ScoredSeat;
+
+static int compare_scored_seats(const void *a, const void *b) {
+    const ScoredSeat *x = (const ScoredSeat *)a, *y = (const ScoredSeat *)b;
+    if (x->score != y->score) return (x->score > y->score) ? -1 : 1;
+    return x->seat - y->seat;
+}
+
+/* Seat quality: the stage is in front of row A of the floor, so lower
+ * tiers beat higher ones, front rows beat back rows, and seats near the
+ * centre line of their row beat the ends (an end seat costs ~4 rows). */
+static int compute_seat_score(const Section *s, int row, int col) {
+    int off = 2 * col - (s->cols - 1);
+    if (off < 0) off = -off;
+    return 1000000 - s->tier * 100000 - row * 100 - (off * 400) / (s->cols > 1 ? s->cols : 1);
+}
+
+/* Mark the accessible rows/seats listed in each section's access spec */
+static int build_accessible(VenueLayout *v) {
+    v->accessible = (uint64_t *)calloc((size_t)v->total_words, sizeof(uint64_t));
+    if (!v->accessible) return 0;
+    for (int i = 0; i < v->section_count; ++i) {
+        Section *s = &v->sections[i];
+        if (!s->access[0]) continue;
+        char buf[MAX_ACCESS_SPEC];
+        strcpy(buf, s->access);
+        char *save = NULL;
+        for (char *tok = strtok_r(buf, ",", &save); tok; tok = strtok_r(NULL, ",", &save)) {
+            int row, col;
+            int kind = parse_row_and_seat(tok, &row, &col);
+            if (kind == 0 || row >= s->rows || (kind == 1 && (col < 0 || col >= s->cols))) return 0;
+            uint64_t *w = v->accessible + s->word_offset + (size_t)row * s->words_per_row;
+            int first = (kind == 1) ? col : 0;
+            int last = (kind == 1) ? col : s->cols - 1;
+            for (int c = first; c <= last; ++c) w[c >> 6] |= (uint64_t)1 << (c & 63);
+        }
+    }
+    return 1;
+}
+
+/* Per-seat scores and the best-to-worst ranking, computed once per layout */
+static int build_seat_ranking(VenueLayout *v) {
+    v->seat_score = (int *)malloc(sizeof(int) * (size_t)v->total_seats);
+    v->rank_order = (int *)malloc(sizeof(int) * (size_t)v->total_seats);
+    ScoredSeat *tmp = (ScoredSeat *)malloc(sizeof(ScoredSeat) * (size_t)v->total_seats);
+    if (!v->seat_score || !v->rank_order || !tmp) { free(tmp); return 0; }
+    for (int i = 0; i < v->section_count; ++i) {
+        const Section *s = &v->sections[i];
+        for (int r = 0; r < s->rows; ++r) {
+            for (int c = 0; c < s->cols; ++c) {
+                int seat = s->seat_offset + r * s->cols + c;
+                v->seat_score[seat] = compute_seat_score(s, r, c);
+                tmp[seat].score = v->seat_score[seat];
+                tmp[seat].seat = seat;
+            }
+        }
+    }
+    qsort(tmp, (size_t)v->total_seats, sizeof(ScoredSeat), compare_scored_seats);
+    for (int i = 0; i < v->total_seats; ++i) v->rank_order[i] = tmp[i].seat;
+    free(tmp);
+    return 1;
+}
+
+/* Fill in derived offsets; returns 0 if the layout exceeds venue limits */
+static int venue_layout_finish(VenueLayout *v) {
+    int words = 0, rows = 0, seats = 0;
+    for (int i = 0; i < v->section_count; ++i) {
+        Section *s = &v->sections[i];
+        if (s->rows < 1 || s->rows > MAX_SECTION_ROWS) return 0;
+        if (s->cols < 1 || s->cols > MAX_SECTION_COLS) return 0;
+        if (s->price_factor <= 0) return 0;
+        s->words_per_row = (s->cols + 63) / 64;
+        s->word_offset = words;
+        s->row_offset = rows;
+        s->seat_offset = seats;
+        words += s->rows * s->words_per_row;
+        rows += s->rows;
+        seats += s->rows * s->cols;
+        if (seats > MAX_VENUE_SEATS) return 0;
+    }
+    v->total_words = words;
+    v->total_rows = rows;
+    v->total_seats = seats;
+    if (v->section_count == 0) return 0;
+    if (!build_accessible(v) || !build_seat_ranking(v)) return 0;
+    v->row_section = (int *)malloc(sizeof(int) * (size_t)v->total_rows);
+    if (!v->row_section) return 0;
+    for (int i = 0; i < v->section_count; ++i) {
+        for (int r = 0; r < v->sections[i].rows; ++r) v->row_section[v->sections[i].row_offset + r] = i;
+    }
+
+    char spec[MAX_LAYOUT_SPEC];
+    venue_layout_format(v, spec, sizeof(spec));
+    v->spec = (char *)malloc(strlen(spec) + 1);
+    if (!v->spec) return 0;
+    strcpy(v->spec, spec);
+    return 1;
+}
+
+static int section_name_valid(const char *name) {
+    size_t n = strlen(name);
+    if (n == 0 || n >= MAX_SECTION_NAME) return 0;
+    for (size_t i = 0; i < n; ++i) if (!isalnum((unsigned char)name[i])) return 0;
+    return 1;
+}
+
+/* Spec: sections separated by ';', each NAME[/TIER]:ROWSxCOLS[@FACTOR]
+ * optionally followed by "+aisle=10,30" (aisle after seats 10 and 30) and
+ * "+access=A,B1,B2" (accessible whole rows or single seats),
+ * e.g. "FLOOR:20x40@1.5+aisle=20;L101/1:25x30+access=A;U201/2:30x40@0.6" */
+VenueLayout *venue_layout_parse(const char *spec) {
+    if (!spec || !spec[0] || strlen(spec) >= MAX_LAYOUT_SPEC) return NULL;
+    char buf[MAX_LAYOUT_SPEC];
+    strcpy(buf, spec);
+
+    VenueLayout *v = (VenueLayout *)calloc(1, sizeof(VenueLayout));
+    if (!v) return NULL;
+    v->sections = (Section *)calloc(MAX_SECTIONS, sizeof(Section));
+    if (!v->sections) { free(v); return NULL; }
+
+    char *save = NULL;
+    for (char *part = strtok_r(buf, ";", &save); part; part = strtok_r(NULL, ";", &save)) {
+        if (v->section_count >= MAX_SECTIONS) goto invalid;
+        Section *s = &v->sections[v->section_count];
+        char *mods = strchr(part, '+');
+        if (mods) *mods++ = '\0';
+        char *colon = strchr(part, ':');
+        if (!colon) goto invalid;
+        *colon = '\0';
+        char *slash = strchr(part, '/');
+        s->tier = 0;
+        if (slash) { *slash = '\0'; s->tier = atoi(slash + 1); }
+        if (!section_name_valid(part)) goto invalid;
+        for (int i = 0; i < v->section_count; ++i) {
+            if (strcasecmp(v->sections[i].name, part) == 0) goto invalid;
+        }
+        strcpy(s->name, part);
+        char *dims = colon + 1;
+        char *at = strchr(dims, '@');
+        s->price_factor = 1.0;
+        if (at) { *at = '\0'; s->price_factor = atof(at + 1); }
+        if (sscanf(dims, "%dx%d", &s->rows, &s->cols) != 2) goto invalid;
+        if (s->cols < 1 || s->cols > MAX_SECTION_COLS) goto invalid;
+
+        char *msave = NULL;
+        for (char *m = mods ? strtok_r(mods, "+", &msave) : NULL; m; m = strtok_r(NULL, "+", &msave)) {
+            if (strncmp(m, "aisle=", 6) == 0) {
+                char *asave = NULL;
+                for (char *a = strtok_r(m + 6, ",", &asave); a; a = strtok_r(NULL, ",", &asave)) {
+                    int after = atoi(a);
+                    if (after < 1 || after >= s->cols) goto invalid;
+                    s->aisle_after[(after - 1) >> 6] |= (uint64_t)1 << ((after - 1) & 63);
+                }
+            } else if (strncmp(m, "access=", 7) == 0) {
+                if (strlen(m + 7) >= MAX_ACCESS_SPEC) goto invalid;
+                strcpy(s->access, m + 7);
+            } else {
+                goto invalid;
+            }
+        }
+        v->section_count++;
+    }
+    if (!venue_layout_finish(v)) goto invalid;
+    return v;
+
+invalid:
+    venue_layout_free(v);
+    return NULL;
+}
+
+void venue_layout_format(const VenueLayout *v, char *out, size_t n) {
+    size_t used = 0;
+    out[0] = '\0';
+    for (int i = 0; i < v->section_count && used < n; ++i) {
+        const Section *s = &v->sections[i];
+        int w = snprintf(out + used, n - used, "%s%s/%d:%dx%d@%.2f", i ? ";" : "",
+                         s->name, s->tier, s->rows, s->cols, s->price_factor);
+        if (w < 0) break;
+        used += (size_t)w;
+        for (int c = 0, first = 1; c < s->cols - 1 && used < n; ++c) {
+            if (!venue_aisle_after(v, i, c)) continue;
+            w = snprintf(out + used, n - used, "%s%d", first ? "+aisle=" : ",", c + 1);
+            if (w < 0) return;
+            used += (size_t)w;
+            first = 0;
+        }
+        if (s->access[0] && used < n) {
+            w = snprintf(out + used, n - used, "+access=%s", s->access);
+            if (w < 0) return;
+            used += (size_t)w;
+        }
+    }
+}
+
+void venue_layout_free(VenueLayout *v) {
+    if (!v) return;
+    free(v->sections);
+    free(v->spec);
+    free(v->seat_score);
+    free(v->rank_order);
+    free(v->accessible);
+    free(v->row_section);
+    free(v);
+}
+
+/* A plain rows x cols hall, as created before sections existed */
+int venue_is_grid(const VenueLayout *v) {
+    const Section *s = &v->sections[0];
+    if (v->section_count != 1 || strcmp(s->name, "MAIN") != 0 || s->tier != 0 ||
+        s->price_factor != 1.0 || s->access[0]) return 0;
+    for (int i = 0; i < MAX_SECTION_COLS / 64; ++i) if (s->aisle_after[i]) return 0;
+    return 1;
+}
+
+int venue_seat_valid(const VenueLayout *v, SeatRef s) {
+    if (s.section < 0 || s.section >= v->section_count) return 0;
+    const Section *sec = &v->sections[s.section];
+    return s.row >= 0 && s.row < sec->rows && s.col >= 0 && s.col < sec->cols;
+}
+
+int venue_seat_number(const VenueLayout *v, SeatRef s) {
+    const Section *sec = &v->sections[s.section];
+    return sec->seat_offset + s.row * sec->cols + s.col;
+}
+
+SeatRef venue_seat_from_number(const VenueLayout *v, int seat) {
+    int lo = 0, hi = v->section_count - 1;
+    while (lo < hi) {
+        int mid = (lo + hi + 1) / 2;
+        if (v->sections[mid].seat_offset <= seat) lo = mid; else hi = mid - 1;
+    }
+    const Section *sec = &v->sections[lo];
+    SeatRef s = { lo, (seat - sec->seat_offset) / sec->cols, (seat - sec->seat_offset) % sec->cols };
+    return s;
+}
+
+int venue_seat_score(const VenueLayout *v, SeatRef s) {
+    return v->seat_score[venue_seat_number(v, s)];
+}
+
+int venue_seat_accessible(const VenueLayout *v, SeatRef s) {
+    const Section *sec = &v->sections[s.section];
+    const uint64_t *w = v->accessible + sec->word_offset + (size_t)s.row * sec->words_per_row;
+    return (int)((w[s.col >> 6] >> (s.col & 63)) & 1u);
+}
+
+/* Is there an aisle between seat col and col+1 of a section? */
+int venue_aisle_after(const VenueLayout *v, int section, int col) {
+    const Section *sec = &v->sections[section];
+    if (col < 0 || col >= sec->cols - 1) return 0;
+    return (int)((sec->aisle_after[col >> 6] >> (col & 63)) & 1u);
+}
+
+/* ============= SHARED LAYOUTS AND TEMPLATES ============= */
+
+static VenueLayout **registry = NULL;
+static int registry_count = 0;
+static int registry_capacity = 0;
+
+static int registry_add(VenueLayout *v) {
+    if (registry_count >= registry_capacity) {
+        int cap = registry_capacity ? registry_capacity * 2 : 8;
+        VenueLayout **tmp = (VenueLayout **)realloc(registry, sizeof(VenueLayout *) * (size_t)cap);
+        if (!tmp) return 0;
+        registry = tmp;
+        registry_capacity = cap;
+    }
+    registry[registry_count++] = v;
+    return 1;
+}
+
+static void registry_remove(VenueLayout *v) {
+    for (int i = 0; i < registry_count; ++i) {
+        if (registry[i] == v) {
+            registry[i] = registry[--registry_count];
+            return;
+        }
+    }
+}
+
+/* Shared layout for a spec; identical specs (including those of named
+ * templates) resolve to the same precomputed layout */
+VenueLayout *venue_layout_intern(const char *spec) {
+    VenueLayout *v = venue_layout_parse(spec);
+    if (!v) return NULL;
+    for (int i = 0; i < registry_count; ++i) {
+        if (strcmp(registry[i]->spec, v->spec) == 0) {
+            venue_layout_free(v);
+            registry[i]->refcount++;
+            return registry[i];
+        }
+    }
+    if (!registry_add(v)) { venue_layout_free(v); return NULL; }
+    v->refcount = 1;
+    return v;
+}
+
+VenueLayout *venue_layout_intern_grid(int rows, int cols) {
+    char spec[64];
+    snprintf(spec, sizeof(spec), "MAIN/0:%dx%d@1.00", rows, cols);
+    return venue_layout_intern(spec);
+}
+
+VenueLayout *venue_template_get(const char *name) {
+    for (int i = 0; i < registry_count; ++i) {
+        if (registry[i]->name[0] && strcasecmp(registry[i]->name, name) == 0) {
+            registry[i]->refcount++;
+            return registry[i];
+        }
+    }
+    return NULL;
+}
+
+/* Register a named template; the registry keeps one reference to it */
+int venue_template_define(const char *name, const char *spec) {
+    size_t n = strlen(name);
+    if (n == 0 || n >= MAX_TEMPLATE_NAME) return 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (!isalnum((unsigned char)name[i]) && name[i] != '_' && name[i] != '-') return 0;
+    }
+    VenueLayout *existing = venue_template_get(name);
+    if (existing) { venue_layout_release(existing); return 0; }
+    VenueLayout *v = venue_layout_intern(spec);
+    if (!v) return 0;
+    if (v->name[0]) {
+        /* Same geometry already has a name; keep a separate named copy */
+        venue_layout_release(v);
+        v = venue_layout_parse(spec);
+        if (!v || !registry_add(v)) { venue_layout_free(v); return 0; }
+        v->refcount = 1;
+    }
+    strcpy(v->name, name);
+    return 1;
+}
+
+void venue_layout_release(VenueLayout *v) {
+    if (!v) return;
+    if (--v->refcount > 0) return;
+    registry_remove(v);
+    venue_layout_free(v);
+}
+
+void list_venue_templates(void) {
+    int shown = 0;
+    printf("\nVenue templates:\n");
+    for (int i = 0; i < registry_count; ++i) {
+        const VenueLayout *v = registry[i];
+        if (!v->name[0]) continue;
+        printf(" - %s: %d seats in %d section%s (used by %d event%s)\n", v->name, v->total_seats,
+               v->section_count, v->section_count > 1 ? "s" : "", v->refcount - 1, v->refcount - 1 == 1 ? "" : "s");
+        printf("   %s\n", v->spec);
+        shown = 1;
+    }
+    if (!shown) printf(" (none defined)\n");
+}
+
+/* Format: name|layout spec */
+void load_venue_templates(const char *path) {
+    FILE *fp = fopen(path, "r");
+    if (!fp) return; /* ok if file absent */
+    char line[MAX_TEMPLATE_NAME + MAX_LAYOUT_SPEC + 4];
+    while (fgets(line, sizeof(line), fp)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        char *bar = strchr(line, '|');
+        if (!bar) continue;
+        *bar = '\0';
+        if (!venue_template_define(line, bar + 1)) fprintf(stderr, "Skipping invalid venue template '%s'\n", line);
+    }
+    fclose(fp);
+}
+
+void save_venue_templates(const char *path) {
+    TextBuf tb;
+    tb_init(&tb, 1024);
+    for (int i = 0; i < registry_count; ++i) {
+        if (registry[i]->name[0]) tb_printf(&tb, "%s|%s\n", registry[i]->name, registry[i]->spec);
+    }
+    submit_snapshot(path, &tb);
+}
+
+void cleanup_venue_templates(void) {
+    for (int i = 0; i < registry_count; ++i) venue_layout_free(registry[i]);
+    free(registry);
+    registry = NULL;
+    registry_count = registry_capacity = 0;
+}
+
+/* ============= OCCUPANCY BITMAPS ============= */
+
+int occupancy_init(SeatOccupancy *o, const VenueLayout *v) {
+    o->bits = (uint64_t *)calloc((size_t)v->total_words, sizeof(uint64_t));
+    o->row_free = (int *)malloc(sizeof(int) * (size_t)v->total_rows);
+    o->section_booked = (int *)calloc((size_t)v->section_count, sizeof(int));
+    o->booked = 0;
+    if (!o->bits || !o->row_free || !o->section_booked) { occupancy_free(o); return 0; }
+    for (int i = 0; i < v->section_count; ++i) {
+        const Section *s = &v->sections[i];
+        for (int r = 0; r < s->rows; ++r) o->row_free[s->row_offset + r] = s->cols;
+    }
+    return 1;
+}
+
+void occupancy_free(SeatOccupancy *o) {
+    free(o->bits);
+    free(o->row_free);
+    free(o->section_booked);
+    o->bits = NULL;
+    o->row_free = NULL;
+    o->section_booked = NULL;
+    o->booked = 0;
+}
+
+static uint64_t *row_words(const SeatOccupancy *o, const Section *s, int row) {
+    return o->bits + s->word_offset + (size_t)row * s->words_per_row;
+}
+
+int occupancy_test(const SeatOccupancy *o, const VenueLayout *v, SeatRef s) {
+    const Section *sec = &v->sections[s.section];
+    const uint64_t *w = row_words(o, sec, s.row);
+    return (int)((w[s.col >> 6] >> (s.col & 63)) & 1u);
+}
+
+void occupancy_set(SeatOccupancy *o, const VenueLayout *v, SeatRef s) {
+    const Section *sec = &v->sections[s.section];
+    uint64_t *w = row_words(o, sec, s.row);
+    uint64_t mask = (uint64_t)1 << (s.col & 63);
+    if (w[s.col >> 6] & mask) return;
+    w[s.col >> 6] |= mask;
+    o->row_free[sec->row_offset + s.row]--;
+    o->section_booked[s.section]++;
+    o->booked++;
+}
+
+void occupancy_clear(SeatOccupancy *o, const VenueLayout *v, SeatRef s) {
+    const Section *sec = &v->sections[s.section];
+    uint64_t *w = row_words(o, sec, s.row);
+    uint64_t mask = (uint64_t)1 << (s.col & 63);
+    if (!(w[s.col >> 6] & mask)) return;
+    w[s.col >> 6] &= ~mask;
+    o->row_free[sec->row_offset + s.row]++;
+    o->section_booked[s.section]--;
+    o->booked--;
+}
+
+/* First column starting n consecutive free seats in a row, or -1.
+ * Whole free or whole booked words are skipped 64 seats at a time. */
+int occupancy_find_run(const SeatOccupancy *o, const VenueLayout *v, int section, int row, int n) {
+    const Section *sec = &v->sections[section];
+    if (n < 1 || o->row_free[sec->row_offset + row] < n) return -1;
+    const uint64_t *w = row_words(o, sec, row);
+    int run = 0, start = 0;
+    for (int wi = 0; wi < sec->words_per_row; ++wi) {
+        int base = wi * 64;
+        int limit = sec->cols - base;
+        if (limit > 64) limit = 64;
+        uint64_t word = w[wi];
+        if (word == 0 && limit == 64) {
+            if (run == 0) start = base;
+            run += 64;
+            if (run >= n) return start;
+            continue;
+        }
+        if (word == ~(uint64_t)0) { run = 0; continue; }
+        for (int b = 0; b < limit; ++b) {
+            if ((word >> b) & 1u) {
+                run = 0;
+            } else {
+                if (run == 0) start = base + b;
+                if (++run >= n) return start;
+            }
+        }
+    }
+    return -1;
+}
+
+/* ============= SEAT LABELS ============= */
+
+void format_row_label(int row, char *out) {
+    if (row < 26) {
+        out[0] = (char)('A' + row);
+        out[1] = '\0';
+    } else {
+        row -= 26;
+        out[0] = (char)('A' + row / 26);
+        out[1] = (char)('A' + row % 26);
+        out[2] = '\0';
+    }
+}
+
+void format_seat_label(const VenueLayout *v, SeatRef s, char *out, size_t n) {
+    char row[3];
+    format_row_label(s.row, row);
+    if (v->section_count > 1) snprintf(out, n, "%s-%s%d", v->sections[s.section].name, row, s.col + 1);
+    else snprintf(out, n, "%s%d", row, s.col + 1);
+}
+
+/* Accepts "A1", "aa12" and "SECTION-A1"; the section prefix is required
+ * when the venue has more than one section. Returns 1 if the seat exists. */
+int parse_seat_label(const VenueLayout *v, const char *text, SeatRef *out) {
+    while (*text && isspace((unsigned char)*text)) text++;
+    const char *dash = strchr(text, '-');
+    int section = 0;
+    if (dash) {
+        size_t n = (size_t)(dash - text);
+        section = -1;
+        for (int i = 0; i < v->section_count; ++i) {
+            if (strlen(v->sections[i].name) == n && strncasecmp(v->sections[i].name, text, n) == 0) { section = i; break; }
+        }
+        if (section < 0) return 0;
+        text = dash + 1;
+    } else if (v->section_count > 1) {
+        return 0;
+    }
+
+    int row, col;
+    if (parse_row_and_seat(text, &row, &col) != 1) return 0;
+    out->section = section;
+    out->row = row;
+    out->col = col;
+    return venue_seat_valid(v, *out);
+}
+
+/* "B" -> whole row (returns 2), "B12" -> one seat (returns 1), else 0 */
+static int parse_row_and_seat(const char *text, int *row, int *col) {
+    int letters = 0;
+    while (isalpha((unsigned char)text[letters])) letters++;
+    if (letters < 1 || letters > 2) return 0;
+    *row = toupper((unsigned char)text[0]) - 'A';
+    if (letters == 2) *row = 26 + *row * 26 + (toupper((unsigned char)text[1]) - 'A');
+    const char *p = text + letters;
+    while (*p && isspace((unsigned char)*p)) p++;
+    if (!*p) { *col = -1; return 2; }
+    if (!isdigit((unsigned char)*p)) return 0;
+    char *end = NULL;
+    long c = strtol(p, &end, 10);
+    while (*end && isspace((unsigned char)*end)) end++;
+    if (*end) return 0;
+    *col = (int)c - 1;
+    return 1;
+}
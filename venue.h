@@ -0,0 +1,102 @@
+#ifndef VENUE_H
+#define VENUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MAX_SECTION_NAME 16
+#define MAX_SECTIONS 64
+#define MAX_SECTION_ROWS 702     /* row labels A..Z, then AA..ZZ */
+#define MAX_SECTION_COLS 512
+#define MAX_VENUE_SEATS 250000
+#define MAX_SEAT_LABEL 32
+#define MAX_LAYOUT_SPEC 2048
+#define MAX_TEMPLATE_NAME 32
+#define MAX_ACCESS_SPEC 64
+
+/* A seat position: section index, row and column within that section */
+typedef struct SeatRef {
+    int section;
+    int row;
+    int col;
+} SeatRef;
+
+typedef struct Section {
+    char name[MAX_SECTION_NAME];
+    int tier;              /* 0 = floor, 1 = lower bowl, 2 = upper bowl, ... */
+    int rows;
+    int cols;
+    double price_factor;   /* price zone: multiplier on the event base price */
+    int words_per_row;     /* 64-bit words per row in the occupancy bitmap */
+    int word_offset;       /* first bitmap word of this section */
+    int row_offset;        /* rows in earlier sections (index into per-row arrays) */
+    int seat_offset;       /* seats in earlier sections */
+    uint64_t aisle_after[MAX_SECTION_COLS / 64];  /* bit c: aisle between seats c and c+1 */
+    char access[MAX_ACCESS_SPEC];  /* accessible rows/seats as written, e.g. "A,B1,B2" */
+} Section;
+
+/* Venue geometry: sections stacked one after another. Layouts are shared
+ * read-only by every event using them (see venue_layout_intern()); all
+ * per-seat data is precomputed once when the layout is built. */
+typedef struct VenueLayout {
+    char name[MAX_TEMPLATE_NAME];  /* template name, empty for ad-hoc layouts */
+    char *spec;                    /* canonical layout spec (registry key) */
+    int refcount;
+    Section *sections;
+    int section_count;
+    int total_rows;
+    int total_seats;
+    int total_words;
+    int *seat_score;        /* quality score per seat number, higher is better */
+    int *rank_order;        /* seat numbers from best to worst */
+    uint64_t *accessible;   /* wheelchair-accessible seats, same shape as occupancy */
+    int *row_section;       /* section of each row, indexed by row_offset + row */
+} VenueLayout;
+
+/* Per-event occupancy: one bit per seat (rows padded to whole words),
+ * plus free-seat counters so full rows and sections are skipped quickly */
+typedef struct SeatOccupancy {
+    uint64_t *bits;
+    int *row_free;
+    int *section_booked;
+    int booked;
+} SeatOccupancy;
+
+/* Layouts */
+VenueLayout *venue_layout_parse(const char *spec);
+void venue_layout_format(const VenueLayout *v, char *out, size_t n);
+void venue_layout_free(VenueLayout *v);
+int venue_is_grid(const VenueLayout *v);
+int venue_seat_valid(const VenueLayout *v, SeatRef s);
+int venue_seat_number(const VenueLayout *v, SeatRef s);
+SeatRef venue_seat_from_number(const VenueLayout *v, int seat);
+int venue_seat_score(const VenueLayout *v, SeatRef s);
+int venue_seat_accessible(const VenueLayout *v, SeatRef s);
+int venue_aisle_after(const VenueLayout *v, int section, int col);
+
+/* Shared layouts and named templates. Every acquired layout must be
+ * released; named templates stay registered until cleanup. */
+VenueLayout *venue_layout_intern(const char *spec);
+VenueLayout *venue_layout_intern_grid(int rows, int cols);
+VenueLayout *venue_template_get(const char *name);
+int venue_template_define(const char *name, const char *spec);
+void venue_layout_release(VenueLayout *v);
+void list_venue_templates(void);
+void load_venue_templates(const char *path);
+void save_venue_templates(const char *path);
+void cleanup_venue_templates(void);
+
+/* Occupancy */
+int occupancy_init(SeatOccupancy *o, const VenueLayout *v);
+void occupancy_free(SeatOccupancy *o);
+int occupancy_test(const SeatOccupancy *o, const VenueLayout *v, SeatRef s);
+void occupancy_set(SeatOccupancy *o, const VenueLayout *v, SeatRef s);
+void occupancy_clear(SeatOccupancy *o, const VenueLayout *v, SeatRef s);
+int occupancy_find_run(const SeatOccupancy *o, const VenueLayout *v, int section, int row, int n);
+
+/* Seat labels: "A1", "AA12" or, in multi-section venues, "FLOOR-A1" */
+void format_row_label(int row, char *out);
+void format_seat_label(const VenueLayout *v, SeatRef s, char *out, size_t n);
+int parse_seat_label(const VenueLayout *v, const char *text, SeatRef *out);
+
+#endif /* VENUE_H */
@@ -0,0 +1,217 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "waitroom.h"
+#include "events.h"
+#include "utils.h"
+
+WaitRoom *waitroom_create(double rate, int burst) {
+    WaitRoom *r = (WaitRoom *)calloc(1, sizeof(WaitRoom));
+    if (!r) { fprintf(stderr, "Memory allocation failed\n"); exit(1); }
+    r->rate = rate;
+    r->burst = burst;
+    r->tokens = burst;
+    r->refilled_ms = now_ms();
+    r->passes = (AdmissionPass *)malloc(sizeof(AdmissionPass) * (size_t)burst);
+    if (!r->passes) { fprintf(stderr, "Memory allocation failed\n"); exit(1); }
+    return r;
+}
+
+void waitroom_free(WaitRoom *r) {
+    if (!r) return;
+    free(r->queue);
+    free(r->passes);
+    free(r);
+}
+
+/* ============= BUCKET AND PASSES ============= */
+
+static void refill(WaitRoom *r, double now) {
+    r->tokens += (now - r->refilled_ms) * r->rate / 1000.0;
+    if (r->tokens > r->burst) r->tokens = r->burst;
+    r->refilled_ms = now;
+}
+
+static int find_pass(const WaitRoom *r, const char *username) {
+    for (int i = 0; i < r->pass_count; ++i)
+        if (strcmp(r->passes[i].username, username) == 0) return i;
+    return -1;
+}
+
+static void drop_pass(WaitRoom *r, int i) {
+    r->passes[i] = r->passes[--r->pass_count];
+}
+
+static void expire_passes(WaitRoom *r, double now) {
+    for (int i = r->pass_count - 1; i >= 0; --i) {
+        if (r->passes[i].expires_ms > now) continue;
+        drop_pass(r, i);
+        r->expired++;
+    }
+}
+
+/* ============= VIRTUAL QUEUE ============= */
+
+static WaitEntry *queue_at(WaitRoom *r, int pos) {
+    return &r->queue[(r->head + pos) % r->cap];
+}
+
+static int find_queued(WaitRoom *r, const char *username) {
+    for (int i = 0; i < r->count; ++i)
+        if (strcmp(queue_at(r, i)->username, username) == 0) return i;
+    return -1;
+}
+
+static void queue_push(WaitRoom *r, const char *username, double now) {
+    if (r->count == r->cap) {
+        int cap = r->cap ? r->cap * 2 : 16;
+        WaitEntry *q = (WaitEntry *)malloc(sizeof(WaitEntry) * (size_t)cap);
+        if (!q) { fprintf(stderr, "Memory allocation failed\n"); exit(1); }
+        for (int i = 0; i < r->count; ++i) q[i] = *queue_at(r, i);
+        free(r->queue);
+        r->queue = q;
+        r->head = 0;
+        r->cap = cap;
+    }
+    WaitEntry *e = queue_at(r, r->count++);
+    snprintf(e->username, sizeof(e->username), "%s", username);
+    e->joined_ms = now;
+}
+
+/* Someone leaving from the middle closes the gap, keeping arrival order */
+static void queue_remove(WaitRoom *r, int pos) {
+    for (int i = pos; i + 1 < r->count; ++i) *queue_at(r, i) = *queue_at(r, i + 1);
+    r->count--;
+}
+
+/* Let the head of the queue in while there are tokens and pass slots */
+static void admit_waiting(WaitRoom *r, double now) {
+    while (r->count > 0 && r->tokens >= 1.0 && r->pass_count < r->burst) {
+        WaitEntry *e = queue_at(r, 0);
+        AdmissionPass *p = &r->passes[r->pass_count++];
+        snprintf(p->username, sizeof(p->username), "%s", e->username);
+        p->expires_ms = now + WAITROOM_PASS_SECONDS * 1000.0;
+        r->tokens -= 1.0;
+        r->admitted++;
+        r->head = (r->head + 1) % r->cap;
+        r->count--;
+    }
+}
+
+/* ============= PUBLIC API ============= */
+
+static WaitRoom *room_of(int event_idx) {
+    if (event_idx < 0 || event_idx >= event_count) return NULL;
+    return event_info[event_idx].room;
+}
+
+int waitroom_join(int event_idx, const char *username, double *eta_seconds) {
+    WaitRoom *r = room_of(event_idx);
+    *eta_seconds = 0;
+    if (!r) return 0;
+    double now = now_ms();
+    refill(r, now);
+    expire_passes(r, now);
+    if (find_pass(r, username) >= 0) return 0;
+    if (find_queued(r, username) < 0) queue_push(r, username, now);
+    admit_waiting(r, now);
+    if (find_pass(r, username) >= 0) return 0;
+
+    /* Everyone ahead needs a token first; a full set of passes can hold
+     * the line up further, so this is a lower bound */
+    int pos = find_queued(r, username) + 1;
+    double wait = (pos - r->tokens) / r->rate;
+    *eta_seconds = wait > 0 ? wait : 0;
+    return pos;
+}
+
+int waitroom_has_pass(int event_idx, const char *username) {
+    WaitRoom *r = room_of(event_idx);
+    if (!r) return 1;
+    expire_passes(r, now_ms());
+    return find_pass(r, username) >= 0;
+}
+
+void waitroom_leave(int event_idx, const char *username) {
+    WaitRoom *r = room_of(event_idx);
+    if (!r) return;
+    int i = find_pass(r, username);
+    if (i >= 0) drop_pass(r, i);
+    i = find_queued(r, username);
+    if (i >= 0) queue_remove(r, i);
+}
+
+/* ============= INTERACTIVE ============= */
+
+void waitroom_wait_turn(int event_idx, const char *username) {
+    if (!room_of(event_idx)) return;
+    double eta;
+    int pos = waitroom_join(event_idx, username, &eta);
+    if (pos > 0) printf("\nThis on-sale is busy, so you have joined the virtual queue.\n");
+    int shown = 0;
+    while (pos > 0) {
+        if (pos != shown) {
+            printf("  Position in queue: %d (estimated wait %.0f s)\n", pos, eta + 0.5);
+            fflush(stdout);
+            shown = pos;
+        }
+        /* Check again when the next admission is due, at least once a second */
+        double nap = eta < 1.0 ? eta : 1.0;
+        if (nap < 0.05) nap = 0.05;
+        struct timespec ts = { (time_t)nap, (long)((nap - (time_t)nap) * 1e9) };
+        nanosleep(&ts, NULL);
+        pos = waitroom_join(event_idx, username, &eta);
+    }
+    printf("You're in! Complete your booking within %d minutes.\n", WAITROOM_PASS_SECONDS / 60);
+}
+
+static void print_room_status(int event_idx) {
+    const WaitRoom *r = event_info[event_idx].room;
+    if (!r) {
+        printf("No waiting room: customers book %s directly.\n", event_info[event_idx].name);
+        return;
+    }
+    printf("Waiting room for %s: %.2f admissions/s, burst %d\n", event_info[event_idx].name, r->rate, r->burst);
+    printf("  Queued: %d | Booking now: %d | Admitted: %ld | Passes expired: %ld\n",
+           r->count, r->pass_count, r->admitted, r->expired);
+}
+
+void waitroom_configure_interactive(void) {
+    if (event_count == 0) { printf("No events.\n"); return; }
+    list_events_brief();
+    printf("Enter event number: ");
+    int ev = read_int(); ev -= 1;
+    if (ev < 0 || ev >= event_count) { printf("Invalid event.\n"); return; }
+    print_room_status(ev);
+
+    printf("Admissions per second (0 = no waiting room, blank = keep): ");
+    char buf[32];
+    read_line(buf, sizeof(buf));
+    if (!buf[0]) return;
+    double rate = atof(buf);
+    EventInfo *info = &event_info[ev];
+    if (rate <= 0) {
+        /* Anyone still queued just books directly from now on */
+        waitroom_free(info->room);
+        info->room = NULL;
+    } else {
+        printf("Burst (customers let in at once, 1-1000): ");
+        int burst = read_int();
+        if (burst < 1 || burst > 1000) { printf("Invalid burst.\n"); return; }
+        if (info->room && burst >= info->room->pass_count) {
+            /* Keep the queue and passes already handed out */
+            AdmissionPass *p = (AdmissionPass *)realloc(info->room->passes, sizeof(AdmissionPass) * (size_t)burst);
+            if (!p) { fprintf(stderr, "Memory allocation failed\n"); exit(1); }
+            info->room->passes = p;
+            info->room->rate = rate;
+            info->room->burst = burst;
+            if (info->room->tokens > burst) info->room->tokens = burst;
+        } else {
+            waitroom_free(info->room);
+            info->room = waitroom_create(rate, burst);
+        }
+    }
+    save_events_to_file("events.txt");
+    print_room_status(ev);
+}
@@ -0,0 +1,58 @@
+#ifndef WAITROOM_H
+#define WAITROOM_H
+
+#include "users.h"
+
+/* Admission control for busy on-sales. An event with a waiting room lets
+ * customers into the booking flow at a fixed rate (token bucket); everyone
+ * else waits in a FIFO virtual queue and is told their position and an
+ * estimated wait. Being let in grants a time-boxed pass, which a booking
+ * needs in order to commit. Events without a room book as before. */
+
+#define WAITROOM_PASS_SECONDS 180   /* time to finish a booking once admitted */
+
+typedef struct WaitEntry {
+    char username[MAX_USERNAME];
+    double joined_ms;
+} WaitEntry;
+
+typedef struct AdmissionPass {
+    char username[MAX_USERNAME];
+    double expires_ms;
+} AdmissionPass;
+
+typedef struct WaitRoom {
+    double rate;          /* admissions per second */
+    int burst;            /* bucket size, and the most passes out at once */
+    double tokens;
+    double refilled_ms;
+    WaitEntry *queue;     /* ring buffer in arrival order */
+    int head;
+    int count;
+    int cap;
+    AdmissionPass *passes;
+    int pass_count;
+    long admitted;        /* totals, for the admin view */
+    long expired;
+} WaitRoom;
+
+WaitRoom *waitroom_create(double rate, int burst);
+void waitroom_free(WaitRoom *r);
+
+/* Take (or keep) a place in the event's queue. Returns 0 once the caller
+ * holds a pass (always, for an event without a room), otherwise the
+ * 1-based queue position with the estimated wait in *eta_seconds. */
+int waitroom_join(int event_idx, const char *username, double *eta_seconds);
+
+/* Whether username may commit a booking for the event right now */
+int waitroom_has_pass(int event_idx, const char *username);
+
+/* Hand back a pass or a queue place when the customer is done */
+void waitroom_leave(int event_idx, const char *username);
+
+/* Customer side: queue and wait until admitted, printing progress */
+void waitroom_wait_turn(int event_idx, const char *username);
+
+void waitroom_configure_interactive(void);
+
+#endif /* WAITROOM_H */
@@ -0,0 +1,86 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "workers.h"
+
+#define MAX_WORKER_THREADS 64
+#define RENDER_BATCH 256   /* items rendered before their output is written */
+
+int worker_threads = 1;
+
+typedef struct WorkerArg {
+    int first;
+    int stride;
+    int count;
+    void (*fn)(int i, void *ctx);
+    void *ctx;
+} WorkerArg;
+
+int default_worker_threads(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    if (n < 1) n = 1;
+    if (n > MAX_WORKER_THREADS) n = MAX_WORKER_THREADS;
+    return (int)n;
+}
+
+static void *worker_main(void *p) {
+    WorkerArg *a = (WorkerArg *)p;
+    for (int i = a->first; i < a->count; i += a->stride) a->fn(i, a->ctx);
+    return NULL;
+}
+
+void parallel_for(int count, void (*fn)(int i, void *ctx), void *ctx) {
+    if (count <= 0) return;
+    int nthreads = worker_threads;
+    if (nthreads > MAX_WORKER_THREADS) nthreads = MAX_WORKER_THREADS;
+    if (nthreads > count) nthreads = count;
+    if (nthreads <= 1) {
+        for (int i = 0; i < count; ++i) fn(i, ctx);
+        return;
+    }
+
+    pthread_t tids[MAX_WORKER_THREADS];
+    WorkerArg args[MAX_WORKER_THREADS];
+    int started[MAX_WORKER_THREADS];
+    for (int t = 0; t < nthreads; ++t) {
+        args[t].first = t;
+        args[t].stride = nthreads;
+        args[t].count = count;
+        args[t].fn = fn;
+        args[t].ctx = ctx;
+        started[t] = (pthread_create(&tids[t], NULL, worker_main, &args[t]) == 0);
+        /* If a thread can't be started, do its share on this thread */
+        if (!started[t]) worker_main(&args[t]);
+    }
+    for (int t = 0; t < nthreads; ++t) {
+        if (started[t]) pthread_join(tids[t], NULL);
+    }
+}
+
+typedef struct RenderJob {
+    int first;
+    TextBuf *bufs;
+    void (*render)(int i, TextBuf *out, void *ctx);
+    void *ctx;
+} RenderJob;
+
+static void render_one(int i, void *p) {
+    RenderJob *job = (RenderJob *)p;
+    job->render(job->first + i, &job->bufs[i], job->ctx);
+}
+
+/* Items are rendered in batches so output starts early and memory stays
+ * bounded by one batch of buffers */
+void parallel_render(int count, void (*render)(int i, TextBuf *out, void *ctx), void *ctx, FILE *out) {
+    TextBuf bufs[RENDER_BATCH];
+    for (int i = 0; i < RENDER_BATCH; ++i) tb_init(&bufs[i], 1024);
+    RenderJob job = { 0, bufs, render, ctx };
+    for (job.first = 0; job.first < count; job.first += RENDER_BATCH) {
+        int n = count - job.first < RENDER_BATCH ? count - job.first : RENDER_BATCH;
+        for (int i = 0; i < n; ++i) bufs[i].len = 0;
+        parallel_for(n, render_one, &job);
+        for (int i = 0; i < n; ++i) fwrite(bufs[i].data, 1, bufs[i].len, out);
+    }
+    for (int i = 0; i < RENDER_BATCH; ++i) tb_free(&bufs[i]);
+}
@@ -0,0 +1,20 @@
+#ifndef WORKERS_H
+#define WORKERS_H
+
+#include <stdio.h>
+#include "utils.h"
+
+/* Number of worker threads used by parallel phases (1 = run inline) */
+extern int worker_threads;
+
+int default_worker_threads(void);
+
+/* Run fn(i, ctx) for i in [0, count) across worker_threads threads.
+ * Work is split in a strided fashion; returns when every call has finished. */
+void parallel_for(int count, void (*fn)(int i, void *ctx), void *ctx);
+
+/* Report pipeline: render(i, buf, ctx) fills a private buffer per item on
+ * the worker threads; buffers are written to out in item order */
+void parallel_render(int count, void (*render)(int i, TextBuf *out, void *ctx), void *ctx, FILE *out);
+
+#endif /* WORKERS_H */